@@ -0,0 +1,63 @@
+// allocations.cpp
+#include "allocations.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<int64_t> allocatedBytes{0};
+
+void* allocate(std::size_t size) {
+    void* block = std::malloc(size ? size : 1);
+    if (!block) throw std::bad_alloc();
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(static_cast<int64_t>(malloc_usable_size(block)), std::memory_order_relaxed);
+    return block;
+}
+
+void release(void* block) {
+    if (!block) return;
+    allocatedBytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+}
+
+namespace allocations {
+
+uint64_t count() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+int64_t liveBytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* block) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block) noexcept {
+    release(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    release(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    release(block);
+}
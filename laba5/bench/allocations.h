@@ -0,0 +1,20 @@
+// allocations.h
+// Счетчики выделений памяти для бенчмарков: глобальные operator new/delete
+// подменены в allocations.cpp и учитывают число выделений и объем живых блоков
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <cstdint>
+
+namespace allocations {
+
+// Число вызовов operator new с начала работы программы
+uint64_t count();
+
+// Байты в блоках, выделенных через operator new и еще не освобожденных
+// (с учетом округления malloc, по malloc_usable_size)
+int64_t liveBytes();
+
+}
+
+#endif
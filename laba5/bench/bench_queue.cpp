@@ -0,0 +1,259 @@
+// bench_queue.cpp
+// Очередь (ex2): постановка билетов (исходные строковые билеты против записей
+// с числовым номером), онлайн-постановка, распределение стратегией LPT,
+// DISTRIBUTE целиком на 1-8 потоках, сравнение всех стратегий DISTRIBUTE
+// по качеству и времени, симуляция смены с пуассоновскими приходами и DONE
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../queue_system.h"
+#include "allocations.h"
+#include "workloads.h"
+
+static void BM_QueueOnlineEnqueue(benchmark::State& state) {
+    std::vector<int> durations = workloads::ticketDurations(static_cast<size_t>(state.range(0)),
+                                                            workloads::TicketSet::RANDOM, 1);
+    for (auto _ : state) {
+        std::ostringstream output;
+        ex2::QueueSystem system(8, true, output);
+        for (int duration : durations) system.enqueue(duration);
+        benchmark::DoNotOptimize(output.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueueOnlineEnqueue)->Arg(100)->Arg(100000);
+
+namespace {
+
+// Билет исходной версии ex2: номер - строка "TXXX" из stringstream со случайным
+// числом 0..999 (номера повторяются), хранится в векторе вместе с длительностью
+struct LegacyTicket {
+    std::string number;
+    int duration;
+};
+
+struct LegacyQueue {
+    std::vector<LegacyTicket> tickets;
+    std::mt19937 random{1};
+    std::uniform_int_distribution<> number{0, 999};
+    std::ostream& out;
+
+    explicit LegacyQueue(std::ostream& output) : out(output) {}
+
+    void enqueue(int duration) {
+        std::stringstream ss;
+        ss << "T" << std::setw(3) << std::setfill('0') << number(random);
+        tickets.push_back({ss.str(), duration});
+        out << ">>> " << tickets.back().number << '\n';
+    }
+};
+
+// Поток вывода, который ничего не хранит: память замеряется без буфера ответов
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override {
+        return c;
+    }
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        return count;
+    }
+};
+
+// Постановка всех билетов в очередь; счетчик bytes_per_ticket - прирост живой памяти
+// на билет после отдельного прогона без учета вывода
+template <typename Queue>
+void runEnqueue(benchmark::State& state) {
+    std::vector<int> durations = workloads::ticketDurations(static_cast<size_t>(state.range(0)),
+                                                            workloads::TicketSet::RANDOM, 1);
+    {
+        NullBuffer discard;
+        std::ostream output(&discard);
+        int64_t before = allocations::liveBytes();
+        std::unique_ptr<Queue> queue = std::make_unique<Queue>(output);
+        for (int duration : durations) queue->enqueue(duration);
+        state.counters["bytes_per_ticket"] =
+            static_cast<double>(allocations::liveBytes() - before) / static_cast<double>(durations.size());
+    }
+    for (auto _ : state) {
+        std::ostringstream output;
+        Queue queue(output);
+        for (int duration : durations) queue.enqueue(duration);
+        benchmark::DoNotOptimize(output.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+struct OfflineQueueSystem : ex2::QueueSystem {
+    explicit OfflineQueueSystem(std::ostream& output) : ex2::QueueSystem(8, false, output) {}
+};
+
+}
+
+// Билеты до и после перехода на записи с числовым номером в непрерывном массиве
+static void BM_QueueEnqueueLegacy(benchmark::State& state) {
+    runEnqueue<LegacyQueue>(state);
+}
+BENCHMARK(BM_QueueEnqueueLegacy)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+static void BM_QueueEnqueue(benchmark::State& state) {
+    runEnqueue<OfflineQueueSystem>(state);
+}
+BENCHMARK(BM_QueueEnqueue)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+// DISTRIBUTE целиком (LPT): параллельная сортировка, назначение окон и сборка вывода
+// (в никуда). Аргументы: число потоков и число билетов; ускорение - отношение
+// времени с одним потоком ко времени с N потоками
+static void BM_QueueDistribute(benchmark::State& state) {
+    unsigned threads = static_cast<unsigned>(state.range(0));
+    std::vector<int> durations = workloads::ticketDurations(static_cast<size_t>(state.range(1)),
+                                                            workloads::TicketSet::RANDOM, 1);
+    std::unique_ptr<ex2::Scheduler> scheduler = ex2::makeScheduler("LPT");
+    NullBuffer discard;
+    std::ostream output(&discard);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto system = std::make_unique<ex2::QueueSystem>(8, false, output);
+        for (int duration : durations) system->enqueue(duration);
+        state.ResumeTiming();
+        system->distribute(*scheduler, threads);
+    }
+    state.counters["threads"] = threads;
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_QueueDistribute)
+    ->ArgsProduct({{1, 2, 4, 8}, {100, 100000000}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Смена зала в онлайн-режиме: пуассоновские приходы, каждое окно обслуживает свои
+// билеты по порядку и сообщает DONE по окончании. Порядок ENQUEUE и DONE заранее
+// рассчитан по той же куче загрузок, что у QueueSystem, так что в цикле замеряется
+// только сама очередь. Аргументы: число окон и число билетов
+static void BM_QueuePoissonShift(benchmark::State& state) {
+    struct Event {
+        int window;           // -1 - постановка билета, иначе окно, обслужившее билет
+        int duration;
+        std::string ticket;
+    };
+    int windowsCount = static_cast<int>(state.range(0));
+    std::vector<workloads::Arrival> arrivals =
+        workloads::poissonArrivals(static_cast<size_t>(state.range(1)), windowsCount, 0.9, 1);
+
+    std::vector<Event> events;
+    events.reserve(arrivals.size() * 2);
+    ex2::IndexedMinHeap windowLoads(windowsCount);
+    std::vector<double> freeAt(windowsCount, 0);
+    using Finish = std::tuple<double, int, uint32_t, int>;   // время, окно, билет, длительность
+    std::priority_queue<Finish, std::vector<Finish>, std::greater<Finish>> finishes;
+    auto finish = [&] {
+        auto [time, window, id, duration] = finishes.top();
+        finishes.pop();
+        std::ostringstream number;
+        number << ex2::TicketNumber{id};
+        windowLoads.add(window, -duration);
+        events.push_back({window, duration, number.str()});
+    };
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        while (!finishes.empty() && std::get<0>(finishes.top()) <= arrivals[i].time) finish();
+        int window = windowLoads.top();
+        windowLoads.add(window, arrivals[i].duration);
+        freeAt[window] = std::max(freeAt[window], arrivals[i].time) + arrivals[i].duration;
+        finishes.push({freeAt[window], window, static_cast<uint32_t>(i + 1), arrivals[i].duration});
+        events.push_back({-1, arrivals[i].duration, {}});
+    }
+    while (!finishes.empty()) finish();
+
+    auto replay = [&](std::ostream& output) {
+        ex2::QueueSystem system(windowsCount, true, output);
+        for (const Event& event : events) {
+            if (event.window < 0) system.enqueue(event.duration);
+            else system.complete(event.window + 1, event.ticket);
+        }
+    };
+    std::ostringstream check;
+    replay(check);
+    if (check.str().find("Ошибка") != std::string::npos) {
+        state.SkipWithError("trace diverged from QueueSystem assignments");
+        return;
+    }
+
+    for (auto _ : state) {
+        std::ostringstream output;
+        replay(output);
+        benchmark::DoNotOptimize(output.tellp());
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(BM_QueuePoissonShift)->Args({8, 100})->Args({1000, 1000000})->Unit(benchmark::kMillisecond);
+
+// Время самой стратегии: билеты заранее отсортированы по убыванию длительности
+static void BM_QueueAssignLpt(benchmark::State& state) {
+    std::vector<int> durations = workloads::ticketDurations(static_cast<size_t>(state.range(0)),
+                                                            workloads::TicketSet::RANDOM, 1);
+    std::vector<ex2::Ticket> tickets;
+    for (size_t i = 0; i < durations.size(); ++i) tickets.push_back({static_cast<uint32_t>(i + 1), durations[i]});
+    std::stable_sort(tickets.begin(), tickets.end(), std::greater<ex2::Ticket>());
+    std::unique_ptr<ex2::Scheduler> scheduler = ex2::makeScheduler("LPT");
+    for (auto _ : state) {
+        ex2::Schedule schedule = scheduler->assign(tickets, 8);
+        benchmark::DoNotOptimize(schedule.loads.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueueAssignLpt)->Arg(100)->Arg(1000000);
+
+// Качество и время стратегий DISTRIBUTE: счетчики makespan (наибольшая загрузка
+// окна), нижняя граница max(ceil(сумма / W), самый длинный билет) и их отношение.
+// Аргументы: число окон и число билетов
+static void BM_QueueSchedule(benchmark::State& state, const char* strategy, workloads::TicketSet set) {
+    int windowsCount = static_cast<int>(state.range(0));
+    std::vector<int> durations = workloads::ticketDurations(static_cast<size_t>(state.range(1)), set, 1);
+    std::vector<ex2::Ticket> tickets;
+    tickets.reserve(durations.size());
+    for (size_t i = 0; i < durations.size(); ++i) tickets.push_back({static_cast<uint32_t>(i + 1), durations[i]});
+    std::stable_sort(tickets.begin(), tickets.end(), std::greater<ex2::Ticket>());
+
+    long long total = 0;
+    for (int duration : durations) total += duration;
+    long long lowerBound = std::max<long long>((total + windowsCount - 1) / windowsCount, tickets.front().duration);
+
+    std::unique_ptr<ex2::Scheduler> scheduler = ex2::makeScheduler(strategy);
+    long long makespan = 0;
+    for (auto _ : state) {
+        ex2::Schedule schedule = scheduler->assign(tickets, windowsCount);
+        makespan = *std::max_element(schedule.loads.begin(), schedule.loads.end());
+        benchmark::DoNotOptimize(schedule.loads.data());
+    }
+    state.counters["makespan"] = static_cast<double>(makespan);
+    state.counters["lower_bound"] = static_cast<double>(lowerBound);
+    state.counters["ratio"] = static_cast<double>(makespan) / static_cast<double>(lowerBound);
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+    state.SetLabel(workloads::ticketSetName(set));
+}
+
+// Размеры от 10^2 до 10^7 билетов; имя вида .../windows/tickets, чтобы
+// bench_smoke выбирал наименьший размер по окончанию "/100"
+static void scheduleArgs(benchmark::internal::Benchmark* b) {
+    b->ArgsProduct({{2, 3, 8}, benchmark::CreateRange(100, 10000000, 10)})->Unit(benchmark::kMillisecond);
+}
+
+// KK делит билеты только на два окна
+static void twoWindowScheduleArgs(benchmark::internal::Benchmark* b) {
+    b->ArgsProduct({{2}, benchmark::CreateRange(100, 10000000, 10)})->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_CAPTURE(BM_QueueSchedule, lpt_random, "LPT", workloads::TicketSet::RANDOM)->Apply(scheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, lpt_adversarial, "LPT", workloads::TicketSet::ADVERSARIAL)->Apply(scheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, kk_random, "KK", workloads::TicketSet::RANDOM)->Apply(twoWindowScheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, kk_adversarial, "KK", workloads::TicketSet::ADVERSARIAL)->Apply(twoWindowScheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, multifit_random, "MULTIFIT", workloads::TicketSet::RANDOM)->Apply(scheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, multifit_adversarial, "MULTIFIT", workloads::TicketSet::ADVERSARIAL)->Apply(scheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, bnb_random, "BNB", workloads::TicketSet::RANDOM)->Apply(scheduleArgs);
+BENCHMARK_CAPTURE(BM_QueueSchedule, bnb_adversarial, "BNB", workloads::TicketSet::ADVERSARIAL)->Apply(scheduleArgs);
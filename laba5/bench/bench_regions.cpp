@@ -0,0 +1,317 @@
+// bench_regions.cpp
+// Справочник регионов (ex4): поток изменений и запросов через processCommand,
+// прием 10^8 команд через входной буфер со счетчиком команд, как в ex4.cpp,
+// поток CHANGE/RENAME/ABOUT по исходным unordered_map и map против RegionDirectory,
+// изменения вперемешку с ALL и ALL <префикс> (копия и сортировка против индекса),
+// память истории ревизий и запросы ABOUT @версия и HISTORY
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../region_directory.h"
+#include "allocations.h"
+#include "workloads.h"
+
+static void BM_RegionCommands(benchmark::State& state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::string script = workloads::regionCommands(count, count / 4 + 1, 1);
+    std::string response;
+    for (auto _ : state) {
+        ex4::Output output{ex4::Output::Capture{}};
+        ex4::RegionDirectory directory(output);
+        ex4::CommandScanner scanner(script);
+        for (size_t i = 0; i < count; ++i) {
+            ex4::processCommand(scanner, directory, output);
+            output.take(response);
+            response.clear();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RegionCommands)->Arg(100)->Arg(100000);
+
+// Вход ex4 целиком: число команд и команды одним буфером, разбор CommandScanner и
+// processCommand, ответы копятся в буфере и выбрасываются пачками. Команды - поток
+// CHANGE/RENAME/ABOUT без ALL, чтобы время приема не терялось за выводом списков.
+// Скрипт не длиннее 10^6 команд и прогоняется по кругу (каждый раз с новым
+// справочником), пока не наберется range(0) команд: на 10^8 версий история ревизий
+// заняла бы около 5 ГБ
+static void BM_RegionIngest(benchmark::State& state) {
+    size_t total = static_cast<size_t>(state.range(0));
+    size_t count = std::min<size_t>(total, 1000000);
+    std::string script = std::to_string(count) + "\n"
+        + workloads::regionScript(workloads::regionOps(count, count / 8 + 1, 1));
+    size_t passes = total / count;
+    std::string response;
+    for (auto _ : state) {
+        for (size_t pass = 0; pass < passes; ++pass) {
+            ex4::Output output{ex4::Output::Capture{}};
+            ex4::RegionDirectory directory(output);
+            ex4::CommandScanner scanner(script);
+            int n = scanner.integer();
+            scanner.skipChar();
+            for (int i = 0; i < n; ++i) {
+                ex4::processCommand(scanner, directory, output);
+                if (i % 4096 == 0) {
+                    output.take(response);
+                    response.clear();
+                }
+            }
+            output.take(response);
+            response.clear();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * passes * count);
+    state.SetBytesProcessed(state.iterations() * passes * script.size());
+}
+BENCHMARK(BM_RegionIngest)->Arg(100)->Arg(1000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+namespace {
+
+// Справочник исходной версии ex4 над контейнером Map (unordered_map<string, string>
+// или map<string, string>): find, затем operator[] еще раз или два на команду.
+// Сообщения те же, но пишутся в Output, как у RegionDirectory, а не в cout с endl
+template <typename Map>
+class LegacyDirectory {
+private:
+    ex4::Output& output;
+    Map regions; // region -> center
+
+public:
+    explicit LegacyDirectory(ex4::Output& output) : output(output) {}
+
+    void nextCommand() {}
+
+    void change(const std::string& region, const std::string& new_center) {
+        if (regions.find(region) != regions.end()) {
+            std::string old_center = regions[region];
+            regions[region] = new_center;
+            output.out() << "Region " << region << " has changed its administrative center from "
+                         << old_center << " to " << new_center << '\n';
+        } else {
+            regions[region] = new_center;
+            output.out() << "New region " << region << " with administrative center " << new_center << '\n';
+        }
+    }
+
+    void rename(const std::string& old_region, const std::string& new_region) {
+        if (old_region == new_region || regions.count(old_region) == 0 || regions.count(new_region) > 0) {
+            output.err() << "Incorrect" << '\n';
+            return;
+        }
+        std::string center = regions[old_region];
+        regions.erase(old_region);
+        regions[new_region] = center;
+        output.out() << old_region << " has been renamed to " << new_region << '\n';
+    }
+
+    void about(const std::string& region) const {
+        auto it = regions.find(region);
+        if (it != regions.end()) {
+            output.out() << region << " has administrative center " << it->second << '\n';
+        } else {
+            output.err() << "Incorrect" << '\n';
+        }
+    }
+
+    // Копия всех записей и сортировка на каждый вызов; префикс отбирается при выводе
+    void all(const std::string& prefix = "") const {
+        std::vector<std::pair<std::string, std::string>> sorted_regions(regions.begin(), regions.end());
+        std::sort(sorted_regions.begin(), sorted_regions.end());
+        for (const auto& [region, center] : sorted_regions) {
+            if (region.compare(0, prefix.size(), prefix) == 0) {
+                output.out() << region << " - " << center << '\n';
+            }
+        }
+    }
+};
+
+template <typename Directory>
+void apply(Directory& directory, const workloads::RegionOps& ops, const workloads::RegionOps::Op& op) {
+    directory.nextCommand();
+    const std::string& region = ops.regions[op.region];
+    switch (op.kind) {
+        case workloads::RegionOps::Op::Kind::CHANGE:
+            directory.change(region, ops.centers[op.other]);
+            break;
+        case workloads::RegionOps::Op::Kind::RENAME:
+            directory.rename(region, ops.regions[op.other]);
+            break;
+        case workloads::RegionOps::Op::Kind::ABOUT:
+            directory.about(region);
+            break;
+    }
+}
+
+// Прогон потока операций по справочнику, созданному заново на каждой итерации;
+// ответы забираются из буфера пачками
+template <typename Directory>
+void runRegionOps(benchmark::State& state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    workloads::RegionOps ops = workloads::regionOps(count, count / 8 + 1, 1);
+    std::string response;
+    for (auto _ : state) {
+        ex4::Output output{ex4::Output::Capture{}};
+        Directory directory(output);
+        size_t done = 0;
+        for (const workloads::RegionOps::Op& op : ops.ops) {
+            apply(directory, ops, op);
+            if (++done % 4096 == 0) {
+                output.take(response);
+                response.clear();
+            }
+        }
+        output.take(response);
+        benchmark::DoNotOptimize(response.size());
+        response.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Справочник из range(0) регионов; на итерацию - 16 команд из смешанного потока
+// и ALL с префиксом prefix (пустой - полный список)
+template <typename Directory>
+void runAll(benchmark::State& state, const std::string& prefix) {
+    size_t count = static_cast<size_t>(state.range(0));
+    workloads::RegionOps ops = workloads::regionOps(1 << 20, count, 1);
+    ex4::Output output{ex4::Output::Capture{}};
+    Directory directory(output);
+    for (size_t i = 0; i < count; ++i) {
+        directory.nextCommand();
+        directory.change(ops.regions[i], ops.centers[i % ops.centers.size()]);
+    }
+    std::string response;
+    output.take(response);
+    size_t next = 0;
+    size_t listed = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < 16; ++i) apply(directory, ops, ops.ops[next++ % ops.ops.size()]);
+        output.take(response);
+        response.clear();
+        directory.nextCommand();
+        directory.all(prefix);
+        output.take(response);
+        listed += response.size();
+        response.clear();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_all"] = static_cast<double>(listed) / static_cast<double>(state.iterations());
+}
+
+}
+
+static void BM_RegionOpsUnorderedMap(benchmark::State& state) {
+    runRegionOps<LegacyDirectory<std::unordered_map<std::string, std::string>>>(state);
+}
+BENCHMARK(BM_RegionOpsUnorderedMap)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+static void BM_RegionOpsMap(benchmark::State& state) {
+    runRegionOps<LegacyDirectory<std::map<std::string, std::string>>>(state);
+}
+BENCHMARK(BM_RegionOpsMap)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+static void BM_RegionOps(benchmark::State& state) {
+    runRegionOps<ex4::RegionDirectory>(state);
+}
+BENCHMARK(BM_RegionOps)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+// Изменения вперемешку с ALL: исходная копия с сортировкой против упорядоченного индекса.
+// Префикс Region1234 выбирает ~100 регионов из миллиона
+static void BM_RegionAllLegacy(benchmark::State& state) {
+    runAll<LegacyDirectory<std::unordered_map<std::string, std::string>>>(state, "");
+}
+BENCHMARK(BM_RegionAllLegacy)->Arg(100)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_RegionAll(benchmark::State& state) {
+    runAll<ex4::RegionDirectory>(state, "");
+}
+BENCHMARK(BM_RegionAll)->Arg(100)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_RegionAllPrefixLegacy(benchmark::State& state) {
+    runAll<LegacyDirectory<std::unordered_map<std::string, std::string>>>(state, "Region1234");
+}
+BENCHMARK(BM_RegionAllPrefixLegacy)->Arg(100)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_RegionAllPrefix(benchmark::State& state) {
+    runAll<ex4::RegionDirectory>(state, "Region1234");
+}
+BENCHMARK(BM_RegionAllPrefix)->Arg(100)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+namespace {
+
+// Справочник после count команд смешанного потока (count версий). Строится один раз
+// на размер и переиспользуется: 10^7 команд выполняются около минуты, а Google
+// Benchmark вызывает функцию бенчмарка несколько раз
+struct Versioned {
+    workloads::RegionOps ops;
+    ex4::Output output{ex4::Output::Capture{}};
+    ex4::RegionDirectory directory{output};
+    double bytesPerVersion = 0;
+};
+
+Versioned& versioned(size_t count) {
+    static std::map<size_t, std::unique_ptr<Versioned>> built;
+    std::unique_ptr<Versioned>& entry = built[count];
+    if (!entry) {
+        entry = std::make_unique<Versioned>();
+        entry->ops = workloads::regionOps(count, count / 8 + 1, 1);
+        std::string response;
+        int64_t before = allocations::liveBytes();
+        size_t done = 0;
+        for (const workloads::RegionOps::Op& op : entry->ops.ops) {
+            apply(entry->directory, entry->ops, op);
+            if (++done % 4096 == 0) {
+                entry->output.take(response);
+                response.clear();
+            }
+        }
+        entry->output.take(response);
+        entry->bytesPerVersion = static_cast<double>(allocations::liveBytes() - before) / static_cast<double>(count);
+    }
+    return *entry;
+}
+
+// Запросы по случайным названиям; ответы забираются из буфера пачками.
+// Счетчик bytes_per_version - прирост живой памяти справочника на команду; на малых
+// размерах он завышен первым блоком арены строк (1 МБ)
+template <typename Query>
+void runHistoryQueries(benchmark::State& state, Query query) {
+    size_t count = static_cast<size_t>(state.range(0));
+    Versioned& built = versioned(count);
+    std::mt19937 random(2);
+    std::string response;
+    size_t done = 0;
+    for (auto _ : state) {
+        const std::string& region = built.ops.regions[random() % built.ops.regions.size()];
+        query(built.directory, region, static_cast<uint32_t>(1 + random() % count));
+        if (++done % 4096 == 0) {
+            built.output.take(response);
+            response.clear();
+        }
+    }
+    built.output.take(response);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes_per_version"] = built.bytesPerVersion;
+}
+
+}
+
+// История ревизий после 10^7 команд: память на версию и время ABOUT @версия и HISTORY
+static void BM_RegionAboutAt(benchmark::State& state) {
+    runHistoryQueries(state, [](const ex4::RegionDirectory& directory, const std::string& region, uint32_t at) {
+        directory.about(region, at);
+    });
+}
+BENCHMARK(BM_RegionAboutAt)->Arg(100)->Arg(10000000);
+
+static void BM_RegionHistory(benchmark::State& state) {
+    runHistoryQueries(state, [](const ex4::RegionDirectory& directory, const std::string& region, uint32_t) {
+        directory.history(region);
+    });
+}
+BENCHMARK(BM_RegionHistory)->Arg(100)->Arg(10000000);
@@ -0,0 +1,155 @@
+// bench_tokenizer.cpp
+// Разбор команд: общий токенизатор (tokenizer.h) против исходных путей фронтендов -
+// getline и istringstream в vector<string> с map ключевых слов (ex1, ex3) и
+// cin >> с toupper и цепочкой сравнений (ex2, ex4). Вход - команды ex4 в большом
+// буфере, который прогоняется по кругу, пока не наберется range(0) КБ
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cctype>
+#include <istream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../tokenizer.h"
+#include "workloads.h"
+
+namespace {
+
+enum class Command { CHANGE, RENAME, ABOUT, ALL, UNKNOWN };
+
+constexpr auto commandKeywords = tokenizer::makeKeywordTable<Command>({
+    {"CHANGE", Command::CHANGE},
+    {"RENAME", Command::RENAME},
+    {"ABOUT", Command::ABOUT},
+    {"ALL", Command::ALL},
+}, Command::UNKNOWN);
+
+// Входной поток поверх готового буфера, без копирования текста
+struct ViewBuffer : std::streambuf {
+    explicit ViewBuffer(std::string& text) {
+        setg(text.data(), text.data(), text.data() + text.size());
+    }
+};
+
+// Буфер не больше 64 МБ; passes - сколько раз его прогнать на range(0) КБ входа
+struct Input {
+    std::string text;
+    size_t passes;
+};
+
+Input input(const benchmark::State& state) {
+    size_t total = static_cast<size_t>(state.range(0)) << 10;
+    size_t size = std::min<size_t>(total, 64 << 20);
+    size_t count = size / 24 + 1;    // Средняя длина команды около 24 байт
+    Input result{workloads::regionScript(workloads::regionOps(count, count / 8 + 1, 1)), 0};
+    result.passes = std::max<size_t>(1, total / result.text.size());
+    return result;
+}
+
+void report(benchmark::State& state, const Input& input, size_t tokens) {
+    state.SetItemsProcessed(static_cast<int64_t>(tokens));
+    state.SetBytesProcessed(state.iterations() * input.passes * input.text.size());
+}
+
+std::string toUpper(const std::string& s) {
+    std::string result = s;
+    std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+}
+
+// ex1 и ex3: строка через getline, токены через istringstream в vector<string>,
+// команда - копия в верхнем регистре и поиск в std::map
+static void BM_TokenizeLinesLegacy(benchmark::State& state) {
+    Input text = input(state);
+    static const std::map<std::string, Command> commandMap = {
+        {"CHANGE", Command::CHANGE}, {"RENAME", Command::RENAME}, {"ABOUT", Command::ABOUT}, {"ALL", Command::ALL}};
+    size_t tokens = 0;
+    size_t known = 0;
+    for (auto _ : state) {
+        for (size_t pass = 0; pass < text.passes; ++pass) {
+            ViewBuffer buffer(text.text);
+            std::istream in(&buffer);
+            std::string line;
+            while (std::getline(in, line)) {
+                std::istringstream iss(line);
+                std::vector<std::string> words;
+                std::string word;
+                while (iss >> word) words.push_back(word);
+                if (words.empty()) continue;
+                auto it = commandMap.find(toUpper(words[0]));
+                known += it != commandMap.end();
+                tokens += words.size();
+            }
+        }
+    }
+    benchmark::DoNotOptimize(known);
+    report(state, text, tokens);
+}
+BENCHMARK(BM_TokenizeLinesLegacy)->Arg(100)->Arg(4 << 20)->Unit(benchmark::kMillisecond);
+
+// ex2 и ex4: команда через >>, toupper и сравнения строк, аргументы - по одному >>
+static void BM_TokenizeWordsLegacy(benchmark::State& state) {
+    Input text = input(state);
+    size_t tokens = 0;
+    size_t length = 0;
+    for (auto _ : state) {
+        for (size_t pass = 0; pass < text.passes; ++pass) {
+            ViewBuffer buffer(text.text);
+            std::istream in(&buffer);
+            std::string command, first, second;
+            while (in >> command) {
+                command = toUpper(command);
+                ++tokens;
+                if (command == "CHANGE" || command == "RENAME") {
+                    in >> first >> second;
+                    tokens += 2;
+                } else if (command == "ABOUT") {
+                    in >> first;
+                    ++tokens;
+                }
+                length += first.size();
+            }
+        }
+    }
+    benchmark::DoNotOptimize(length);
+    report(state, text, tokens);
+}
+BENCHMARK(BM_TokenizeWordsLegacy)->Arg(100)->Arg(4 << 20)->Unit(benchmark::kMillisecond);
+
+// Общий токенизатор: string_view на буфер и совершенный хеш ключевых слов,
+// аргументы разбираются так же, как в processCommand ex4
+static void BM_Tokenize(benchmark::State& state) {
+    Input text = input(state);
+    size_t tokens = 0;
+    size_t length = 0;
+    for (auto _ : state) {
+        for (size_t pass = 0; pass < text.passes; ++pass) {
+            tokenizer::Tokenizer scanner(text.text);
+            for (std::string_view command = scanner.token(); !command.empty(); command = scanner.token()) {
+                ++tokens;
+                switch (commandKeywords.find(command)) {
+                    case Command::CHANGE:
+                    case Command::RENAME:
+                        length += scanner.token().size();
+                        length += scanner.token().size();
+                        tokens += 2;
+                        break;
+                    case Command::ABOUT:
+                        length += scanner.token().size();
+                        ++tokens;
+                        break;
+                    case Command::ALL:
+                    case Command::UNKNOWN:
+                        break;
+                }
+            }
+        }
+    }
+    benchmark::DoNotOptimize(length);
+    report(state, text, tokens);
+}
+BENCHMARK(BM_Tokenize)->Arg(100)->Arg(4 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,334 @@
+// bench_trams.cpp
+// Трамвайная сеть (ex3): построение сети, изменения маршрутов, запросы по остановкам
+// (исходные map/set против номеров и плоских массивов, копии против представлений
+// без копирования) и поиск маршрута
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../ex3/tram_manager.h"
+#include "../ex3/journey_planner.h"
+#include "allocations.h"
+#include "workloads.h"
+
+namespace {
+
+// Сеть из range(0) трамваев по 20 остановок; остановок в 4 раза больше трамваев
+workloads::TramNetwork network(const benchmark::State& state) {
+    size_t trams = static_cast<size_t>(state.range(0));
+    return workloads::tramNetwork(trams, 20, trams * 4, 1);
+}
+
+template <typename Manager>
+void build(Manager& manager, const workloads::TramNetwork& network) {
+    for (const auto& [name, stops] : network.routes) manager.createTram(name, stops);
+}
+
+// Счетчик allocs_per_query - число operator new на запрос с момента since
+void countAllocations(benchmark::State& state, uint64_t since) {
+    state.counters["allocs_per_query"] =
+        static_cast<double>(allocations::count() - since) / static_cast<double>(state.iterations());
+}
+
+}
+
+// Построение сети по одному маршруту (createTram) и пачкой, как при LOAD (addRoutes).
+// Время на маршрут не должно расти с размером сети: оценка сложности - O(N)
+static void BM_TramCreate(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    for (auto _ : state) {
+        TramManager manager;
+        build(manager, routes);
+        benchmark::DoNotOptimize(manager.version());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_TramCreate)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond)
+    ->Complexity(benchmark::oN);
+
+static void BM_TramLoadRoutes(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    std::vector<RouteRecord> records;
+    std::vector<std::string_view> stops;
+    for (size_t i = 0; i < routes.routes.size(); ++i) {
+        uint32_t first = static_cast<uint32_t>(stops.size());
+        for (const std::string& stop : routes.routes[i].second) stops.push_back(stop);
+        records.push_back({routes.routes[i].first, first, static_cast<uint32_t>(stops.size()), i + 1});
+    }
+    for (auto _ : state) {
+        TramManager manager;
+        LoadReport report;
+        manager.addRoutes(records, stops, report);
+        benchmark::DoNotOptimize(report.added);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_TramLoadRoutes)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond)
+    ->Complexity(benchmark::oN);
+
+// Поток изменений по готовой сети: ADD_STOP, REMOVE_STOP, CREATE и DELETE вперемешку,
+// в том числе отклоняемые. Переносы и уплотнение общего массива маршрутов входят в время
+static void BM_TramMutations(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    std::vector<workloads::TramMutation> mutations =
+        workloads::tramMutations(100000, routes.routes.size(), routes.stops.size(), 1);
+    TramManager manager;
+    build(manager, routes);
+    size_t next = 0;
+    for (auto _ : state) {
+        const workloads::TramMutation& mutation = mutations[next++ % mutations.size()];
+        switch (mutation.kind) {
+            case workloads::TramMutation::Kind::CREATE:
+                benchmark::DoNotOptimize(manager.createTram(mutation.tram, mutation.route));
+                break;
+            case workloads::TramMutation::Kind::DELETE:
+                benchmark::DoNotOptimize(manager.deleteTram(mutation.tram));
+                break;
+            case workloads::TramMutation::Kind::ADD_STOP:
+                benchmark::DoNotOptimize(manager.addStop(mutation.tram, mutation.stop, mutation.position));
+                break;
+            case workloads::TramMutation::Kind::REMOVE_STOP:
+                benchmark::DoNotOptimize(manager.removeStop(mutation.tram, mutation.stop));
+                break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TramMutations)->Arg(100)->Arg(10000);
+
+
+// ROUTE между случайными парами остановок; 10000 трамваев - сеть из 10k маршрутов.
+// Счетчики: доля пар, между которыми есть путь, и среднее число поездок на найденном пути
+static void BM_TramRoute(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    TramManager manager;
+    build(manager, routes);
+    JourneyPlanner planner(manager);
+    // Зерно отличается от зерна сети: иначе пары повторяют остановки первых маршрутов
+    std::mt19937 random(2);
+    std::vector<std::pair<const std::string*, const std::string*>> pairs(1 << 16);
+    for (auto& [from, to] : pairs) {
+        from = &routes.stops[random() % routes.stops.size()];
+        to = &routes.stops[random() % routes.stops.size()];
+    }
+    std::vector<JourneyLeg> legs;
+    size_t next = 0;
+    size_t found = 0;
+    size_t trips = 0;
+    for (auto _ : state) {
+        const auto& [from, to] = pairs[next++ % pairs.size()];
+        if (planner.findRoute(*from, *to, legs).empty()) {
+            ++found;
+            trips += legs.size();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["found"] = static_cast<double>(found) / static_cast<double>(state.iterations());
+    state.counters["trips"] = found ? static_cast<double>(trips) / static_cast<double>(found) : 0.0;
+}
+BENCHMARK(BM_TramRoute)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+namespace {
+
+// Менеджер исходной версии ex3: маршруты и трамваи остановок - деревья строк,
+// название остановки копируется в каждый маршрут и в индекс
+class MapTramManager {
+public:
+    std::string createTram(const std::string& name, const std::vector<std::string>& stops) {
+        if (stops.size() < 2) {
+            return "ERROR: At least two stops required";
+        }
+        std::set<std::string> unique_stops(stops.begin(), stops.end());
+        if (unique_stops.size() != stops.size()) {
+            return "ERROR: Duplicate stops in route";
+        }
+        if (tram_routes_.count(name)) {
+            return "ERROR: Tram '" + name + "' already exists";
+        }
+        for (const auto& [existing_name, existing_route] : tram_routes_) {
+            if (existing_route == stops) {
+                return "ERROR: Route duplicates existing tram '" + existing_name + "'";
+            }
+        }
+        tram_routes_[name] = stops;
+        for (const auto& stop : stops) {
+            stop_trams_[stop].insert(name);
+        }
+        return "";
+    }
+
+    std::vector<std::string> getTramsInStop(const std::string& stop) const {
+        auto it = stop_trams_.find(stop);
+        return (it != stop_trams_.end())
+            ? std::vector<std::string>(it->second.begin(), it->second.end())
+            : std::vector<std::string>();
+    }
+
+    std::vector<std::pair<std::string, std::set<std::string>>> getStopsInTram(const std::string& tram) const {
+        std::vector<std::pair<std::string, std::set<std::string>>> result;
+        auto tram_it = tram_routes_.find(tram);
+        if (tram_it != tram_routes_.end()) {
+            for (const auto& stop : tram_it->second) {
+                std::set<std::string> other_trams;
+                if (auto stop_it = stop_trams_.find(stop); stop_it != stop_trams_.end()) {
+                    std::copy_if(stop_it->second.begin(), stop_it->second.end(),
+                                 std::inserter(other_trams, other_trams.end()),
+                                 [&tram](const auto& name) { return name != tram; });
+                }
+                result.emplace_back(stop, other_trams);
+            }
+        }
+        return result;
+    }
+
+private:
+    std::map<std::string, std::vector<std::string>> tram_routes_;
+    std::map<std::string, std::set<std::string>> stop_trams_;
+};
+
+// Сеть для запросов; счетчик bytes_per_route - прирост живой памяти на маршрут
+template <typename Manager>
+void buildMeasured(benchmark::State& state, Manager& manager, const workloads::TramNetwork& routes) {
+    int64_t before = allocations::liveBytes();
+    build(manager, routes);
+    state.counters["bytes_per_route"] =
+        static_cast<double>(allocations::liveBytes() - before) / static_cast<double>(routes.routes.size());
+}
+
+template <typename Manager>
+void runGetTramsInStop(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    Manager manager;
+    buildMeasured(state, manager, routes);
+    size_t next = 0;
+    uint64_t allocated = allocations::count();
+    for (auto _ : state) {
+        const std::string& stop = routes.stops[next++ % routes.stops.size()];
+        benchmark::DoNotOptimize(manager.getTramsInStop(stop));
+    }
+    countAllocations(state, allocated);
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Manager>
+void runGetStopsInTram(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    Manager manager;
+    buildMeasured(state, manager, routes);
+    size_t next = 0;
+    uint64_t allocated = allocations::count();
+    for (auto _ : state) {
+        const std::string& tram = routes.routes[next++ % routes.routes.size()].first;
+        benchmark::DoNotOptimize(manager.getStopsInTram(tram));
+    }
+    countAllocations(state, allocated);
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+// Запросы и память до и после перехода на номера и плоские массивы;
+// 12500 трамваев - сеть из 50 000 остановок
+static void BM_TramGetTramsInStopMaps(benchmark::State& state) {
+    runGetTramsInStop<MapTramManager>(state);
+}
+BENCHMARK(BM_TramGetTramsInStopMaps)->Arg(100)->Arg(12500);
+
+static void BM_TramGetTramsInStop(benchmark::State& state) {
+    runGetTramsInStop<TramManager>(state);
+}
+BENCHMARK(BM_TramGetTramsInStop)->Arg(100)->Arg(12500);
+
+static void BM_TramGetStopsInTramMaps(benchmark::State& state) {
+    runGetStopsInTram<MapTramManager>(state);
+}
+BENCHMARK(BM_TramGetStopsInTramMaps)->Arg(100)->Arg(12500);
+
+static void BM_TramGetStopsInTram(benchmark::State& state) {
+    runGetStopsInTram<TramManager>(state);
+}
+BENCHMARK(BM_TramGetStopsInTram)->Arg(100)->Arg(12500);
+
+// Те же запросы без копирования (tramsInStop, forEachStopInTram) и список TRAMS:
+// getAllTrams против forEachTram. Счетчик allocs_per_query сравнивается с
+// BM_TramGetTramsInStop и BM_TramGetStopsInTram
+static void BM_TramsInStop(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    TramManager manager;
+    build(manager, routes);
+    size_t next = 0;
+    uint64_t allocated = allocations::count();
+    for (auto _ : state) {
+        const std::string& stop = routes.stops[next++ % routes.stops.size()];
+        size_t count = 0;
+        for (const std::string& tram : manager.tramsInStop(stop)) count += tram.size();
+        benchmark::DoNotOptimize(count);
+    }
+    countAllocations(state, allocated);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TramsInStop)->Arg(100)->Arg(12500);
+
+static void BM_TramStopsInTramView(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    TramManager manager;
+    build(manager, routes);
+    size_t next = 0;
+    uint64_t allocated = allocations::count();
+    for (auto _ : state) {
+        const std::string& tram = routes.routes[next++ % routes.routes.size()].first;
+        size_t count = 0;
+        manager.forEachStopInTram(tram, [&count](const std::string& stop, NameView trams) {
+            count += stop.size();
+            for (const std::string& other : trams) count += other.size();
+        });
+        benchmark::DoNotOptimize(count);
+    }
+    countAllocations(state, allocated);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TramStopsInTramView)->Arg(100)->Arg(12500);
+
+static void BM_TramListingCopy(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    TramManager manager;
+    build(manager, routes);
+    uint64_t allocated = allocations::count();
+    for (auto _ : state) {
+        size_t count = 0;
+        for (const auto& [tram, stops] : manager.getAllTrams()) {
+            count += tram.size();
+            for (const std::string& stop : stops) count += stop.size();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    countAllocations(state, allocated);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TramListingCopy)->Arg(100)->Arg(12500)->Unit(benchmark::kMicrosecond);
+
+static void BM_TramListing(benchmark::State& state) {
+    workloads::TramNetwork routes = network(state);
+    TramManager manager;
+    build(manager, routes);
+    manager.freeze();
+    uint64_t allocated = allocations::count();
+    for (auto _ : state) {
+        size_t count = 0;
+        manager.forEachTram([&count](const std::string& tram, NameView stops) {
+            count += tram.size();
+            for (const std::string& stop : stops) count += stop.size();
+        });
+        benchmark::DoNotOptimize(count);
+    }
+    countAllocations(state, allocated);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TramListing)->Arg(100)->Arg(12500)->Unit(benchmark::kMicrosecond);
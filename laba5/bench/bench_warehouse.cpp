@@ -0,0 +1,150 @@
+// bench_warehouse.cpp
+// Склад (ex1): разбор и выполнение смешанного потока команд без журнала,
+// пакетный режим на файле команд до 50 млн строк и
+// сравнение хранилищ на потоке ADD/REMOVE - исходный map<string, Cell> против
+// массивов ячеек по номеру адреса
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../warehouse.h"
+#include "workloads.h"
+
+static void BM_WarehouseCommands(benchmark::State& state) {
+    std::string script = workloads::warehouseCommands(static_cast<size_t>(state.range(0)), 1);
+    std::vector<std::string_view> commands = workloads::lines(script);
+    ex1::Warehouse warehouse;
+    ex1::OutputBuffer out;
+    std::vector<std::string_view> tokens;
+    for (auto _ : state) {
+        for (std::string_view line : commands) {
+            ex1::processLine(line, tokens, warehouse, out);
+            out.data.clear();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(commands.size()));
+}
+BENCHMARK(BM_WarehouseCommands)->Arg(100)->Arg(100000);
+
+// Пакетный режим ex1 целиком: чтение файла команд блоками, разбор и сброс ответов
+// (в /dev/null). Файл генерируется один раз частями по миллиону строк во временный файл
+static void BM_WarehouseBatch(benchmark::State& state) {
+    const size_t CHUNK = 1000000;
+    size_t count = static_cast<size_t>(state.range(0));
+    std::FILE* input = std::tmpfile();
+    std::FILE* output = std::fopen("/dev/null", "w");
+    if (!input || !output) {
+        state.SkipWithError("cannot open temporary files");
+        return;
+    }
+    int64_t bytes = 0;
+    for (size_t done = 0; done < count; done += CHUNK) {
+        std::string chunk = workloads::warehouseCommands(std::min(CHUNK, count - done),
+                                                         static_cast<uint32_t>(1 + done / CHUNK));
+        std::fwrite(chunk.data(), 1, chunk.size(), input);
+        bytes += static_cast<int64_t>(chunk.size());
+    }
+
+    ex1::OutputBuffer out;
+    for (auto _ : state) {
+        std::rewind(input);
+        ex1::Warehouse warehouse;
+        ex1::runBatch(input, output, warehouse, out);
+    }
+    std::fclose(input);
+    std::fclose(output);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_WarehouseBatch)->Arg(100)->Arg(1000000)->Arg(50000000)->Unit(benchmark::kMillisecond);
+
+namespace {
+
+// Хранилище исходной версии ex1: ячейки в map по строке адреса, на каждую
+// операцию find и operator[]; сообщения те же, что у Warehouse
+struct MapWarehouse {
+    struct Cell {
+        std::string item;
+        int quantity;
+    };
+
+    std::map<std::string, Cell> cells;
+
+    explicit MapWarehouse(const std::vector<std::string>& addresses) {
+        for (const std::string& address : addresses) cells[address] = {"", 0};
+    }
+
+    void add(const std::string& item, int quantity, const std::string& address, ex1::OutputBuffer& out) {
+        if (cells.find(address) == cells.end()) {
+            out << "Ошибка: ячейка " << address << " не существует\n";
+            return;
+        }
+        Cell& cell = cells[address];
+        if (cell.quantity == 0) {
+            cell.item = item;
+            cell.quantity = quantity;
+            out << "Добавлено " << quantity << " ед. товара \"" << item << "\" в " << address << '\n';
+        } else if (cell.item != item) {
+            out << "Ошибка: ячейка содержит другой товар (\"" << cell.item << "\")\n";
+        } else if (cell.quantity + quantity > ex1::CELL_CAPACITY) {
+            out << "Ошибка: превышен лимит ячейки. Доступно место: " << ex1::CELL_CAPACITY - cell.quantity << '\n';
+        } else {
+            cell.quantity += quantity;
+            out << "Обновлено: " << item << " x" << cell.quantity << " в " << address << '\n';
+        }
+    }
+
+    void remove(const std::string& item, int quantity, const std::string& address, ex1::OutputBuffer& out) {
+        if (cells.find(address) == cells.end()) {
+            out << "Ошибка: ячейка " << address << " не существует\n";
+            return;
+        }
+        Cell& cell = cells[address];
+        if (cell.quantity == 0) {
+            out << "Ошибка: ячейка " << address << " пуста\n";
+        } else if (cell.item != item) {
+            out << "Ошибка: в ячейке находится другой товар (\"" << cell.item << "\")\n";
+        } else if (cell.quantity < quantity) {
+            out << "Ошибка: недостаточно товара. Доступно: " << cell.quantity << '\n';
+        } else {
+            cell.quantity -= quantity;
+            if (cell.quantity == 0) cell.item = "";
+            out << "Удалено " << quantity << " ед. товара \"" << item << "\" из " << address
+                << ". Остаток: " << cell.quantity << '\n';
+        }
+    }
+};
+
+// Прогон потока операций по хранилищу; ответы копятся и сбрасываются пачками
+template <typename Store>
+void runOps(benchmark::State& state, Store& store) {
+    workloads::WarehouseOps ops = workloads::warehouseOps(static_cast<size_t>(state.range(0)), 1);
+    ex1::OutputBuffer out;
+    for (auto _ : state) {
+        for (const workloads::WarehouseOps::Op& op : ops.ops) {
+            const std::string& item = ops.items[op.item];
+            const std::string& address = ops.addresses[op.address];
+            if (op.add) store.add(item, op.quantity, address, out);
+            else store.remove(item, op.quantity, address, out);
+            if (out.data.size() > (1 << 16)) out.data.clear();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+static void BM_WarehouseOpsMap(benchmark::State& state) {
+    MapWarehouse store(workloads::warehouseOps(0, 1).addresses);
+    runOps(state, store);
+}
+BENCHMARK(BM_WarehouseOpsMap)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+static void BM_WarehouseOpsCells(benchmark::State& state) {
+    ex1::Warehouse store;
+    runOps(state, store);
+}
+BENCHMARK(BM_WarehouseOpsCells)->Arg(100)->Arg(10000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Сравнение двух прогонов lab_bench (--benchmark_out_format=json).
+# Выводит изменение времени каждого бенчмарка и завершается с кодом 1,
+# если хотя бы один стал медленнее больше чем на порог (по умолчанию 5%).
+# При --benchmark_repetitions сравниваются медианы повторов.
+import argparse
+import json
+import statistics
+import sys
+
+NANOSECONDS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Имя бенчмарка -> время одной итерации в наносекундах."""
+    with open(path) as f:
+        runs = json.load(f)["benchmarks"]
+    medians = {}
+    samples = {}
+    for run in runs:
+        if run.get("error_occurred"):
+            continue
+        value = run[metric] * NANOSECONDS[run.get("time_unit", "ns")]
+        name = run.get("run_name", run["name"])
+        if run.get("run_type") == "aggregate":
+            if run.get("aggregate_name") == "median":
+                medians[name] = value
+        else:
+            samples.setdefault(name, []).append(value)
+    times = {name: statistics.median(values) for name, values in samples.items()}
+    times.update(medians)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Сравнение двух прогонов lab_bench")
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=5.0, help="допустимое замедление, %%")
+    parser.add_argument("--metric", choices=["cpu_time", "real_time"], default="cpu_time")
+    args = parser.parse_args()
+
+    old = load(args.baseline, args.metric)
+    new = load(args.contender, args.metric)
+
+    regressions = []
+    width = max((len(name) for name in old), default=9)
+    print(f"{'benchmark':<{width}} {'old_ns':>14} {'new_ns':>14} {'change':>9}")
+    for name, before in old.items():
+        if name not in new:
+            print(f"{name:<{width}} {before:>14.1f} {'missing':>14}")
+            continue
+        after = new[name]
+        change = (after / before - 1) * 100 if before > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            regressions.append(name)
+            mark = "  SLOWER"
+        print(f"{name:<{width}} {before:>14.1f} {after:>14.1f} {change:>+8.1f}%{mark}")
+    for name in new:
+        if name not in old:
+            print(f"{name:<{width}} {'new':>14} {new[name]:>14.1f}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower by more than {args.threshold:g}%:")
+        for name in regressions:
+            print(f"  {name}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
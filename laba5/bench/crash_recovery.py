@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# Восстановление склада после аварии: ex1 --data получает поток ADD/REMOVE/MOVE,
+# процесс убивается SIGKILL посреди пачки и запускается заново. Состояние после
+# перезапуска должно совпасть с состоянием после подтвержденного префикса команд
+# (ответы на пачку выводятся только после записи ее в журнал). Допускается еще
+# одна пачка сверх подтвержденной: ее журнал мог успеть записаться, а ответы - нет.
+# Разорванное состояние (не префикс на границе пачки) - ошибка.
+#
+#     crash_recovery.py <путь к ex1> [--trials N] [--commands N] [--seed S]
+import argparse
+import random
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+BLOCK_SIZE = 1 << 20   # блок чтения runBatch (warehouse.cpp): ответы и журнал - по одному на блок
+ITEMS = 24
+
+
+def make_script(seed, count):
+    """Команды, на каждую из которых ex1 печатает ровно одну строку."""
+    rng = random.Random(seed)
+
+    def address():
+        return "%s%d%d%d" % (rng.choice("ABC"), rng.randint(1, 20), rng.randint(1, 5), rng.randint(1, 2))
+
+    lines = []
+    for _ in range(count):
+        item = "item%d" % rng.randrange(ITEMS)
+        kind = rng.random()
+        if kind < 0.55:
+            lines.append("ADD %s %d %s" % (item, rng.randint(1, 10), address()))
+        elif kind < 0.85:
+            lines.append("REMOVE %s %d %s" % (item, rng.randint(1, 5), address()))
+        else:
+            lines.append("MOVE %s %d %s %s" % (item, rng.randint(1, 5), address(), address()))
+    return ("\n".join(lines) + "\n").encode()
+
+
+def group_ends(script):
+    """Число команд, обработанных после каждого блока чтения (границы групп журнала)."""
+    ends = []
+    for end in range(BLOCK_SIZE, len(script), BLOCK_SIZE):
+        ends.append(script.count(b"\n", 0, end))
+    ends.append(script.count(b"\n"))
+    return ends
+
+
+QUERIES = ("INFO\n" + "".join("FIND item%d\n" % i for i in range(ITEMS))).encode()
+
+
+def model_state(ex1, script, prefix):
+    """Ответы на запросы после первых prefix команд, выполненных без хранения."""
+    head = b"".join(script.splitlines(keepends=True)[:prefix])
+    out = subprocess.run([ex1, "--batch"], input=head + QUERIES, stdout=subprocess.PIPE, check=True).stdout
+    return b"".join(out.splitlines(keepends=True)[prefix:])
+
+
+def stored_state(ex1, data):
+    return subprocess.run([ex1, "--batch", "--data", data], input=QUERIES,
+                          stdout=subprocess.PIPE, check=True).stdout
+
+
+def run_until_killed(ex1, data, script, delay):
+    """Запуск с хранением, SIGKILL через delay секунд; возвращает число подтвержденных команд."""
+    proc = subprocess.Popen([ex1, "--batch", "--data", data], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    acknowledged = [0]
+
+    def feed():
+        try:
+            proc.stdin.write(script)
+            proc.stdin.close()
+        except (BrokenPipeError, OSError):
+            pass
+
+    def drain():
+        for _ in proc.stdout:
+            acknowledged[0] += 1
+
+    threads = [threading.Thread(target=feed), threading.Thread(target=drain)]
+    for thread in threads:
+        thread.start()
+    time.sleep(delay)
+    proc.send_signal(signal.SIGKILL)
+    proc.wait()
+    for thread in threads:
+        thread.join()
+    return acknowledged[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SIGKILL посреди пачки и проверка восстановления ex1 --data")
+    parser.add_argument("ex1")
+    parser.add_argument("--trials", type=int, default=6)
+    parser.add_argument("--commands", type=int, default=200000)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    script = make_script(args.seed, args.commands)
+    ends = group_ends(script)
+    total = ends[-1]
+
+    # Время полного прогона задает моменты убийства: от начала до конца работы
+    work = tempfile.mkdtemp(prefix="crash_recovery_")
+    try:
+        started = time.monotonic()
+        subprocess.run([args.ex1, "--batch", "--data", work + "/full"], input=script,
+                       stdout=subprocess.DEVNULL, check=True)
+        duration = time.monotonic() - started
+
+        failures = 0
+        interrupted = 0
+        for trial in range(args.trials):
+            data = "%s/trial%d" % (work, trial)
+            delay = duration * (trial + 0.5) / args.trials
+            acknowledged = run_until_killed(args.ex1, data, script, delay)
+            if acknowledged < total:
+                interrupted += 1
+
+            state = stored_state(args.ex1, data)
+            # Подтвержденный префикс или префикс до конца следующей группы
+            candidates = [acknowledged] + [end for end in ends if end > acknowledged][:1]
+            matched = next((k for k in candidates if model_state(args.ex1, script, k) == state), None)
+            print("trial %d: killed after %.3fs, %d/%d acknowledged, recovered %s"
+                  % (trial, delay, acknowledged, total, "prefix %d" % matched if matched is not None else "MISMATCH"))
+            if matched is None:
+                failures += 1
+
+        if interrupted == 0:
+            print("no trial was killed before the end of input")
+            failures += 1
+        return 1 if failures else 0
+    finally:
+        shutil.rmtree(work, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,130 @@
+// Дифференциальная проверка TramManager: случайные CREATE/DELETE/ADD_STOP/REMOVE_STOP
+// применяются к сети и к простой модели (название -> список остановок). Периодически
+// сеть сравнивается с моделью и с эталоном, заново построенным по модели через
+// createTram: маршруты, списки трамваев на остановках и соседи по остановкам.
+// Расхождение означает испорченный общий массив маршрутов или индексы.
+//
+//     tram_differential [--ops N] [--trams T] [--stops S] [--check-every K] [--seed S]
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../ex3/tram_manager.h"
+#include "workloads.h"
+
+using namespace std;
+
+namespace {
+
+struct Options {
+    size_t ops = 200000;
+    size_t trams = 40;
+    size_t stops = 30;
+    size_t checkEvery = 500;
+    uint32_t seed = 1;
+};
+
+using Model = map<string, vector<string>>;
+
+// Изменение модели вслед за успешно выполненным изменением сети
+void applyToModel(const workloads::TramMutation& mutation, Model& model) {
+    using Kind = workloads::TramMutation::Kind;
+    switch (mutation.kind) {
+        case Kind::CREATE:
+            model[mutation.tram] = mutation.route;
+            break;
+        case Kind::DELETE:
+            model.erase(mutation.tram);
+            break;
+        case Kind::ADD_STOP: {
+            vector<string>& route = model[mutation.tram];
+            route.insert(route.begin() + (mutation.position - 1), mutation.stop);
+            break;
+        }
+        case Kind::REMOVE_STOP: {
+            vector<string>& route = model[mutation.tram];
+            for (auto it = route.begin(); it != route.end(); ++it) {
+                if (*it == mutation.stop) {
+                    route.erase(it);
+                    break;
+                }
+            }
+            break;
+        }
+    }
+}
+
+string applyToNetwork(const workloads::TramMutation& mutation, TramManager& manager) {
+    using Kind = workloads::TramMutation::Kind;
+    switch (mutation.kind) {
+        case Kind::CREATE: return manager.createTram(mutation.tram, mutation.route);
+        case Kind::DELETE: return manager.deleteTram(mutation.tram);
+        case Kind::ADD_STOP: return manager.addStop(mutation.tram, mutation.stop, mutation.position);
+        case Kind::REMOVE_STOP: return manager.removeStop(mutation.tram, mutation.stop);
+    }
+    return "";
+}
+
+// Первое расхождение сети с моделью и эталоном или пустая строка
+string compare(const Options& options, const TramManager& manager, const Model& model) {
+    if (manager.getAllTrams() != model) return "routes differ from the model";
+    if (manager.activeTramCount() != model.size()) return "active tram count differs from the model";
+
+    TramManager oracle;
+    for (const auto& [name, stops] : model) {
+        string error = oracle.createTram(name, stops);
+        if (!error.empty()) return "rebuild rejected " + name + ": " + error;
+    }
+    for (size_t i = 0; i < options.stops; ++i) {
+        string stop = "Stop" + to_string(i);
+        if (manager.getTramsInStop(stop) != oracle.getTramsInStop(stop)) return "trams in " + stop + " differ";
+    }
+    for (size_t i = 0; i < options.trams; ++i) {
+        string tram = "Tram" + to_string(i);
+        if (manager.getStopsInTram(tram) != oracle.getStopsInTram(tram)) return "stops of " + tram + " differ";
+    }
+    return "";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string_view arg = argv[i];
+        size_t value = strtoull(argv[i + 1], nullptr, 10);
+        if (arg == "--ops") options.ops = value;
+        else if (arg == "--trams") options.trams = max<size_t>(1, value);
+        else if (arg == "--stops") options.stops = max<size_t>(2, value);
+        else if (arg == "--check-every") options.checkEvery = max<size_t>(1, value);
+        else if (arg == "--seed") options.seed = static_cast<uint32_t>(value);
+        else {
+            cerr << "Usage: " << argv[0] << " [--ops N] [--trams T] [--stops S] [--check-every K] [--seed S]\n";
+            return 1;
+        }
+    }
+
+    vector<workloads::TramMutation> mutations =
+        workloads::tramMutations(options.ops, options.trams, options.stops, options.seed);
+    TramManager manager;
+    Model model;
+    size_t applied = 0;
+    for (size_t i = 0; i < mutations.size(); ++i) {
+        if (applyToNetwork(mutations[i], manager).empty()) {
+            applyToModel(mutations[i], model);
+            ++applied;
+        }
+        if ((i + 1) % options.checkEvery == 0 || i + 1 == mutations.size()) {
+            string mismatch = compare(options, manager, model);
+            if (!mismatch.empty()) {
+                cerr << "Mismatch after operation " << i + 1 << ": " << mismatch << "\n";
+                return 1;
+            }
+        }
+    }
+    cout << mutations.size() << " operations, " << applied << " applied, network matches the rebuild\n";
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Нагрузочный генератор для ConcurrentTramManager: несколько потоков в одном
+// процессе читают снимки сети (TRAMS_IN_STOP и STOPS_IN_TRAM) и с заданной
+// долей запросов добавляют маршруты (CREATE_TRAM). Для каждого числа потоков
+// выводит пропускную способность и задержки чтений и записей (p50/p99).
+//
+//     tram_load [--threads 1,2,4,...] [--writes <процент>] [--ops N] [--trams T]
+//               [--stops S] [--route L] [--seed S]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../ex3/concurrent_tram_manager.h"
+#include "workloads.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    vector<size_t> threads{1, 2, 4, 8, 16, 32, 64};
+    double writePercent = 1.0;
+    size_t ops = 10000;          // На поток
+    size_t trams = 1000;
+    size_t stops = 500;
+    size_t route = 10;
+    uint32_t seed = 1;
+};
+
+// Задержки одного потока в наносекундах
+struct Latencies {
+    vector<uint32_t> reads;
+    vector<uint32_t> writes;
+};
+
+// Сюда сбрасываются результаты чтений, чтобы компилятор их не выбросил
+atomic<size_t> readSink{0};
+
+uint32_t elapsed(Clock::time_point start) {
+    auto latency = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    return static_cast<uint32_t>(min<long long>(latency, UINT32_MAX));
+}
+
+// Поток нагрузки: чтения по случайным остановкам и трамваям исходной сети,
+// записи - новые маршруты с уникальными именами
+void runWorker(const Options& options, const workloads::TramNetwork& base, ConcurrentTramManager& network,
+               size_t index, atomic<bool>& start, Latencies& latencies) {
+    mt19937 random(options.seed * 1000003 + static_cast<uint32_t>(index));
+    bernoulli_distribution write(options.writePercent / 100.0);
+    latencies.reads.reserve(options.ops);
+    size_t checksum = 0;
+    while (!start.load(memory_order_acquire)) {
+        this_thread::yield();
+    }
+
+    for (size_t op = 0; op < options.ops; ++op) {
+        if (write(random)) {
+            vector<string> stops;
+            for (size_t i = 0; i < options.route; ++i) stops.push_back(base.stops[random() % base.stops.size()]);
+            string name = "Load" + to_string(index) + "_" + to_string(op);
+            Clock::time_point begin = Clock::now();
+            network.createTram(name, stops);
+            latencies.writes.push_back(elapsed(begin));
+        } else if (random() % 2) {
+            const string& stop = base.stops[random() % base.stops.size()];
+            Clock::time_point begin = Clock::now();
+            checksum += network.read([&stop](const TramManager& snapshot) {
+                size_t count = 0;
+                for (const auto& tram : snapshot.tramsInStop(stop)) count += tram.size();
+                return count;
+            });
+            latencies.reads.push_back(elapsed(begin));
+        } else {
+            const string& tram = base.routes[random() % base.routes.size()].first;
+            Clock::time_point begin = Clock::now();
+            checksum += network.read([&tram](const TramManager& snapshot) {
+                size_t count = 0;
+                snapshot.forEachStopInTram(tram, [&count](const string&, NameView trams) {
+                    for (const auto& other : trams) count += other.size();
+                });
+                return count;
+            });
+            latencies.reads.push_back(elapsed(begin));
+        }
+    }
+    readSink.fetch_add(checksum, memory_order_relaxed);
+}
+
+double percentile(const vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    return sorted[min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))] / 1000.0;
+}
+
+vector<size_t> parseList(string_view text) {
+    vector<size_t> values;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        string item(text.substr(0, comma));
+        size_t value = strtoull(item.c_str(), nullptr, 10);
+        if (value > 0) values.push_back(value);
+        text.remove_prefix(comma == string_view::npos ? text.size() : comma + 1);
+    }
+    return values;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string_view arg = argv[i];
+        size_t value = strtoull(argv[i + 1], nullptr, 10);
+        if (arg == "--threads") options.threads = parseList(argv[i + 1]);
+        else if (arg == "--writes") options.writePercent = min(100.0, max(0.0, strtod(argv[i + 1], nullptr)));
+        else if (arg == "--ops") options.ops = max<size_t>(1, value);
+        else if (arg == "--trams") options.trams = max<size_t>(1, value);
+        else if (arg == "--stops") options.stops = max<size_t>(2, value);
+        else if (arg == "--route") options.route = max<size_t>(2, value);
+        else if (arg == "--seed") options.seed = static_cast<uint32_t>(value);
+        else {
+            cerr << "Usage: " << argv[0] << " [--threads 1,2,4,...] [--writes <percent>] [--ops N]"
+                 << " [--trams T] [--stops S] [--route L] [--seed S]\n";
+            return 1;
+        }
+    }
+    if (options.threads.empty()) {
+        cerr << "No thread counts given\n";
+        return 1;
+    }
+
+    workloads::TramNetwork base = workloads::tramNetwork(options.trams, options.route, options.stops, options.seed);
+    cout << "network: " << options.trams << " trams, " << options.stops << " stops; "
+         << options.ops << " ops per thread, " << options.writePercent << "% writes\n"
+         << setw(7) << "threads" << setw(14) << "ops/s"
+         << setw(14) << "read_p50_us" << setw(14) << "read_p99_us"
+         << setw(14) << "write_p50_us" << setw(14) << "write_p99_us" << "\n";
+
+    for (size_t threadCount : options.threads) {
+        // Каждый прогон начинается с одной и той же исходной сети
+        ConcurrentTramManager network;
+        for (const auto& [name, stops] : base.routes) network.submit(name, stops);
+        network.publish();
+
+        vector<Latencies> latencies(threadCount);
+        atomic<bool> start{false};
+        vector<thread> threads;
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back(runWorker, cref(options), cref(base), ref(network), i, ref(start), ref(latencies[i]));
+        }
+        Clock::time_point begin = Clock::now();
+        start.store(true, memory_order_release);
+        for (thread& t : threads) t.join();
+        double seconds = chrono::duration<double>(Clock::now() - begin).count();
+
+        Latencies all;
+        for (const auto& part : latencies) {
+            all.reads.insert(all.reads.end(), part.reads.begin(), part.reads.end());
+            all.writes.insert(all.writes.end(), part.writes.begin(), part.writes.end());
+        }
+        sort(all.reads.begin(), all.reads.end());
+        sort(all.writes.begin(), all.writes.end());
+        size_t total = all.reads.size() + all.writes.size();
+
+        cout << fixed << setprecision(2)
+             << setw(7) << threadCount << setw(14) << static_cast<uint64_t>(total / seconds)
+             << setw(14) << percentile(all.reads, 0.5) << setw(14) << percentile(all.reads, 0.99)
+             << setw(14) << percentile(all.writes, 0.5) << setw(14) << percentile(all.writes, 0.99) << "\n";
+        cout.unsetf(ios::floatfield);
+    }
+    return 0;
+}
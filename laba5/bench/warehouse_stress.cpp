@@ -0,0 +1,208 @@
+// Нагрузочная проверка шардированного склада: несколько потоков одновременно
+// выполняют случайные ADD/REMOVE/MOVE над общим набором ячеек из разных зон,
+// отдельный поток в это время снимает INFO. После каждого прогона проверяется,
+// что в каждой ячейке от 1 до CELL_CAPACITY единиц одного товара, а остаток
+// каждого товара (по FIND и по INFO) равен сумме успешных ADD минус REMOVE.
+// Для каждого числа потоков выводится пропускная способность.
+//
+//     warehouse_stress [--threads 1,2,4,...] [--ops N] [--items I] [--cells C] [--seed S]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../warehouse.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    vector<size_t> threads{1, 2, 4, 8, 16, 32};
+    size_t ops = 20000;         // На поток
+    size_t items = 16;
+    size_t cells = 64;          // Общий набор ячеек, за который соревнуются потоки
+    uint32_t seed = 1;
+};
+
+bool failed(const ex1::OutputBuffer& out) {
+    return out.data.compare(0, 12, "Ошибка") == 0;
+}
+
+// Поток нагрузки; delta[i] - чистое изменение остатка товара i от успешных команд
+void runWorker(const Options& options, const vector<string>& addresses, ex1::Warehouse& warehouse,
+               size_t index, atomic<bool>& start, vector<long long>& delta, size_t& applied) {
+    mt19937 random(options.seed * 1000003 + static_cast<uint32_t>(index));
+    ex1::OutputBuffer out;
+    while (!start.load(memory_order_acquire)) {
+        this_thread::yield();
+    }
+
+    for (size_t op = 0; op < options.ops; ++op) {
+        // Товар ячейки определяется ее номером, перемещения идут между ячейками
+        // одного товара: иначе чужой товар со временем занимает все ячейки
+        size_t cell = random() % addresses.size();
+        size_t item = cell % options.items;
+        string name = "item" + to_string(item);
+        const string& address = addresses[cell];
+        uint32_t kind = random() % 100;
+        out.data.clear();
+        if (kind < 45) {
+            int quantity = 1 + random() % 4;
+            warehouse.add(name, quantity, address, out);
+            if (!failed(out)) delta[item] += quantity;
+        } else if (kind < 80) {
+            int quantity = 1 + random() % 4;
+            warehouse.remove(name, quantity, address, out);
+            if (!failed(out)) delta[item] -= quantity;
+        } else {
+            size_t sameItem = (addresses.size() - item + options.items - 1) / options.items;
+            const string& target = addresses[item + random() % sameItem * options.items];
+            warehouse.move(name, 1 + random() % 4, address, target, out);
+        }
+        if (!failed(out)) ++applied;
+    }
+}
+
+// Разбор строк INFO вида `  A1111: "item3" x7`; пустая строка - все ячейки в порядке
+string checkCells(const ex1::Warehouse& warehouse, vector<long long>* totals) {
+    ex1::OutputBuffer out;
+    warehouse.info(false, out);
+    string_view text = out.data;
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        string_view line = text.substr(0, end);
+        text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+
+        size_t open = line.find(": \"item");
+        size_t close = line.rfind("\" x");
+        if (open == string_view::npos || close == string_view::npos || close < open) continue;
+        size_t item = strtoull(string(line.substr(open + 7, close - open - 7)).c_str(), nullptr, 10);
+        long long quantity = strtoll(string(line.substr(close + 3)).c_str(), nullptr, 10);
+        if (quantity < 1 || quantity > ex1::CELL_CAPACITY) return "cell out of range: " + string(line);
+        if (totals) {
+            if (item >= totals->size()) return "unknown item: " + string(line);
+            (*totals)[item] += quantity;
+        }
+    }
+    return "";
+}
+
+// Остатки по FIND и INFO совпадают с суммой изменений всех потоков
+string checkTotals(const Options& options, const ex1::Warehouse& warehouse, const vector<long long>& expected) {
+    vector<long long> fromInfo(options.items, 0);
+    string error = checkCells(warehouse, &fromInfo);
+    if (!error.empty()) return error;
+
+    for (size_t item = 0; item < options.items; ++item) {
+        string name = "item" + to_string(item);
+        ex1::OutputBuffer out;
+        warehouse.find(name, out);
+        long long found = 0;
+        size_t colon = out.data.find("\": ");
+        if (out.data.find("отсутствует") == string::npos && colon != string::npos) {
+            found = strtoll(out.data.c_str() + colon + 3, nullptr, 10);
+        }
+        if (found != expected[item] || fromInfo[item] != expected[item]) {
+            return name + ": expected " + to_string(expected[item]) + ", FIND " + to_string(found)
+                + ", INFO " + to_string(fromInfo[item]);
+        }
+    }
+    return "";
+}
+
+vector<size_t> parseList(string_view text) {
+    vector<size_t> values;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        string item(text.substr(0, comma));
+        size_t value = strtoull(item.c_str(), nullptr, 10);
+        if (value > 0) values.push_back(value);
+        text.remove_prefix(comma == string_view::npos ? text.size() : comma + 1);
+    }
+    return values;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string_view arg = argv[i];
+        size_t value = strtoull(argv[i + 1], nullptr, 10);
+        if (arg == "--threads") options.threads = parseList(argv[i + 1]);
+        else if (arg == "--ops") options.ops = max<size_t>(1, value);
+        else if (arg == "--items") options.items = max<size_t>(1, value);
+        else if (arg == "--cells") options.cells = max<size_t>(2, value);
+        else if (arg == "--seed") options.seed = static_cast<uint32_t>(value);
+        else {
+            cerr << "Usage: " << argv[0] << " [--threads 1,2,4,...] [--ops N] [--items I] [--cells C] [--seed S]\n";
+            return 1;
+        }
+    }
+    if (options.threads.empty()) {
+        cerr << "No thread counts given\n";
+        return 1;
+    }
+
+    // Ячейки выбираются по всему складу, так что команды MOVE часто затрагивают две зоны
+    mt19937 random(options.seed);
+    vector<string> addresses;
+    for (size_t i = 0; i < options.cells; ++i) addresses.push_back(ex1::decodeAddress(random() % ex1::CELL_COUNT));
+
+    cout << options.ops << " ops per thread, " << options.items << " items, " << options.cells << " cells\n"
+         << setw(7) << "threads" << setw(14) << "ops/s" << setw(12) << "applied" << "\n";
+
+    for (size_t threadCount : options.threads) {
+        ex1::Warehouse warehouse;
+        vector<vector<long long>> deltas(threadCount, vector<long long>(options.items, 0));
+        vector<size_t> applied(threadCount, 0);
+        atomic<bool> start{false};
+        atomic<bool> done{false};
+        vector<thread> threads;
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back(runWorker, cref(options), cref(addresses), ref(warehouse), i, ref(start),
+                                 ref(deltas[i]), ref(applied[i]));
+        }
+
+        // INFO во время нагрузки видит согласованный снимок: ячейки тоже в пределах
+        string readerError;
+        thread reader([&] {
+            while (!done.load(memory_order_acquire) && readerError.empty()) {
+                readerError = checkCells(warehouse, nullptr);
+            }
+        });
+
+        Clock::time_point begin = Clock::now();
+        start.store(true, memory_order_release);
+        for (thread& t : threads) t.join();
+        double seconds = chrono::duration<double>(Clock::now() - begin).count();
+        done.store(true, memory_order_release);
+        reader.join();
+
+        vector<long long> expected(options.items, 0);
+        size_t appliedTotal = 0;
+        for (size_t i = 0; i < threadCount; ++i) {
+            for (size_t item = 0; item < options.items; ++item) expected[item] += deltas[i][item];
+            appliedTotal += applied[i];
+        }
+        string error = !readerError.empty() ? "during load: " + readerError : checkTotals(options, warehouse, expected);
+        if (!error.empty()) {
+            cerr << "Mismatch with " << threadCount << " threads: " << error << "\n";
+            return 1;
+        }
+
+        size_t total = threadCount * options.ops;
+        cout << setw(7) << threadCount << setw(14) << static_cast<uint64_t>(total / seconds)
+             << setw(11) << appliedTotal * 100 / total << "%\n";
+    }
+    return 0;
+}
@@ -0,0 +1,222 @@
+// workloads.cpp
+#include "workloads.h"
+#include <random>
+
+namespace workloads {
+
+namespace {
+
+// Адрес ячейки склада ex1: зона A-C, стеллаж 1-20, секция 1-5, полка 1-2
+std::string randomAddress(std::mt19937& random) {
+    std::string address(1, "ABC"[random() % 3]);
+    address += std::to_string(random() % 20 + 1);
+    address += std::to_string(random() % 5 + 1);
+    address += std::to_string(random() % 2 + 1);
+    return address;
+}
+
+}
+
+std::vector<std::string_view> lines(std::string_view text) {
+    std::vector<std::string_view> result;
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        if (end == std::string_view::npos) end = text.size();
+        result.push_back(text.substr(0, end));
+        text.remove_prefix(end == text.size() ? end : end + 1);
+    }
+    return result;
+}
+
+std::string warehouseCommands(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::string script;
+    script.reserve(count * 24);
+    for (size_t i = 0; i < count; ++i) {
+        std::string item = "item" + std::to_string(random() % 32);
+        std::string quantity = std::to_string(random() % 5 + 1);
+        unsigned kind = random() % 100;
+        if (kind < 45) {
+            script += "ADD " + item + ' ' + quantity + ' ' + randomAddress(random);
+        } else if (kind < 80) {
+            script += "REMOVE " + item + ' ' + quantity + ' ' + randomAddress(random);
+        } else if (kind < 88) {
+            script += "PUT " + item + ' ' + quantity;
+        } else if (kind < 95) {
+            std::string from = randomAddress(random);
+            script += "MOVE " + item + ' ' + quantity + ' ' + from + ' ' + randomAddress(random);
+        } else {
+            script += "FIND " + item;
+        }
+        script += '\n';
+    }
+    return script;
+}
+
+WarehouseOps warehouseOps(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    WarehouseOps result;
+    for (int item = 0; item < 32; ++item) result.items.push_back("item" + std::to_string(item));
+    for (char zone : {'A', 'B', 'C'}) {
+        for (int shelf = 1; shelf <= 20; ++shelf) {
+            for (int section = 1; section <= 5; ++section) {
+                for (int rack = 1; rack <= 2; ++rack) {
+                    result.addresses.push_back(zone + std::to_string(shelf) + std::to_string(section) + std::to_string(rack));
+                }
+            }
+        }
+    }
+    result.ops.resize(count);
+    for (WarehouseOps::Op& op : result.ops) {
+        op.add = random() % 2 == 0;
+        op.quantity = static_cast<uint8_t>(random() % 5 + 1);
+        op.item = static_cast<uint16_t>(random() % result.items.size());
+        op.address = static_cast<uint16_t>(random() % result.addresses.size());
+    }
+    return result;
+}
+
+const char* ticketSetName(TicketSet set) {
+    return set == TicketSet::RANDOM ? "random" : "adversarial";
+}
+
+std::vector<int> ticketDurations(size_t count, TicketSet set, uint32_t seed) {
+    std::mt19937 random(seed);
+    int maxDuration = set == TicketSet::RANDOM ? 60 : 1000000;
+    std::uniform_int_distribution<int> duration(1, maxDuration);
+    std::vector<int> durations(count);
+    for (int& d : durations) d = duration(random);
+    return durations;
+}
+
+std::vector<Arrival> poissonArrivals(size_t count, int windows, double load, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> duration(1, 60);
+    std::exponential_distribution<double> interval(load * windows / 30.5);   // 30.5 - средняя длительность
+    std::vector<Arrival> arrivals(count);
+    double time = 0;
+    for (Arrival& arrival : arrivals) {
+        time += interval(random);
+        arrival = {time, duration(random)};
+    }
+    return arrivals;
+}
+
+TramNetwork tramNetwork(size_t trams, size_t routeLength, size_t stopCount, uint32_t seed) {
+    std::mt19937 random(seed);
+    TramNetwork network;
+    network.stops.reserve(stopCount);
+    for (size_t i = 0; i < stopCount; ++i) network.stops.push_back("Stop" + std::to_string(i));
+
+    // Остановки маршрута не повторяются: выбираются заново, пока не попадется новая
+    std::vector<size_t> lastUsed(stopCount, SIZE_MAX);
+    network.routes.reserve(trams);
+    for (size_t tram = 0; tram < trams; ++tram) {
+        std::vector<std::string> route;
+        while (route.size() < routeLength && route.size() < stopCount) {
+            size_t stop = random() % stopCount;
+            if (lastUsed[stop] == tram) continue;
+            lastUsed[stop] = tram;
+            route.push_back(network.stops[stop]);
+        }
+        network.routes.emplace_back("Tram" + std::to_string(tram), std::move(route));
+    }
+    return network;
+}
+
+std::vector<TramMutation> tramMutations(size_t count, size_t trams, size_t stops, uint32_t seed) {
+    std::mt19937 random(seed);
+    auto tram = [&] { return "Tram" + std::to_string(random() % trams); };
+    auto stop = [&] { return "Stop" + std::to_string(random() % stops); };
+    std::vector<TramMutation> mutations(count);
+    for (TramMutation& mutation : mutations) {
+        unsigned kind = random() % 100;
+        mutation.tram = tram();
+        if (kind < 40) {
+            mutation.kind = TramMutation::Kind::ADD_STOP;
+            mutation.stop = stop();
+            mutation.position = random() % 12 + 1;
+        } else if (kind < 70) {
+            mutation.kind = TramMutation::Kind::REMOVE_STOP;
+            mutation.stop = stop();
+        } else if (kind < 85) {
+            mutation.kind = TramMutation::Kind::CREATE;
+            size_t length = random() % 7 + 2;
+            for (size_t i = 0; i < length; ++i) mutation.route.push_back(stop());
+        } else {
+            mutation.kind = TramMutation::Kind::DELETE;
+        }
+    }
+    return mutations;
+}
+
+std::string regionCommands(size_t count, size_t names, uint32_t seed) {
+    std::mt19937 random(seed);
+    auto name = [&] { return "Region" + std::to_string(random() % names); };
+    std::string script;
+    script.reserve(count * 28);
+    for (size_t i = 0; i < count; ++i) {
+        unsigned kind = random() % 100;
+        if (kind < 50) {
+            script += "CHANGE " + name() + " City" + std::to_string(random() % 1000);
+        } else if (kind < 65) {
+            std::string from = name();
+            script += "RENAME " + from + ' ' + name();
+        } else if (kind < 88) {
+            script += "ABOUT " + name();
+        } else if (kind < 95) {
+            script += "HISTORY " + name();
+        } else {
+            script += "ALL " + name().substr(0, 9);
+        }
+        script += '\n';
+    }
+    return script;
+}
+
+RegionOps regionOps(size_t count, size_t names, uint32_t seed) {
+    std::mt19937 random(seed);
+    RegionOps result;
+    result.regions.reserve(names);
+    for (size_t i = 0; i < names; ++i) result.regions.push_back("Region" + std::to_string(i));
+    for (int i = 0; i < 1000; ++i) result.centers.push_back("City" + std::to_string(i));
+    result.ops.resize(count);
+    for (RegionOps::Op& op : result.ops) {
+        unsigned kind = random() % 100;
+        op.region = static_cast<uint32_t>(random() % names);
+        if (kind < 50) {
+            op.kind = RegionOps::Op::Kind::CHANGE;
+            op.other = static_cast<uint32_t>(random() % result.centers.size());
+        } else if (kind < 70) {
+            op.kind = RegionOps::Op::Kind::RENAME;
+            op.other = static_cast<uint32_t>(random() % names);
+        } else {
+            op.kind = RegionOps::Op::Kind::ABOUT;
+            op.other = 0;
+        }
+    }
+    return result;
+}
+
+std::string regionScript(const RegionOps& ops) {
+    std::string script;
+    script.reserve(ops.ops.size() * 24);
+    for (const RegionOps::Op& op : ops.ops) {
+        const std::string& region = ops.regions[op.region];
+        switch (op.kind) {
+            case RegionOps::Op::Kind::CHANGE:
+                script += "CHANGE " + region + ' ' + ops.centers[op.other];
+                break;
+            case RegionOps::Op::Kind::RENAME:
+                script += "RENAME " + region + ' ' + ops.regions[op.other];
+                break;
+            case RegionOps::Op::Kind::ABOUT:
+                script += "ABOUT " + region;
+                break;
+        }
+        script += '\n';
+    }
+    return script;
+}
+
+}
@@ -0,0 +1,112 @@
+// workloads.h
+// Генераторы нагрузки для бенчмарков: команды склада (ex1), наборы билетов (ex2),
+// трамвайные сети (ex3) и изменения справочника регионов (ex4). Одинаковые
+// аргументы и seed дают одинаковую нагрузку, так что результаты разных сборок
+// можно сравнивать (compare.py).
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace workloads {
+
+// Строки текста без символов перевода строки
+std::vector<std::string_view> lines(std::string_view text);
+
+// Команды склада: ADD и REMOVE (большинство), PUT, MOVE и FIND по товарам
+// из небольшого ассортимента, адреса - по всей сетке склада
+std::string warehouseCommands(size_t count, uint32_t seed);
+
+// Поток ADD/REMOVE для сравнения хранилищ склада: товары и адреса заданы
+// номерами в таблицах, чтобы 10^7 операций занимали мало памяти
+struct WarehouseOps {
+    struct Op {
+        bool add;
+        uint8_t quantity;
+        uint16_t item;
+        uint16_t address;
+    };
+
+    std::vector<std::string> items;
+    std::vector<std::string> addresses;   // Все ячейки склада
+    std::vector<Op> ops;
+};
+
+WarehouseOps warehouseOps(size_t count, uint32_t seed);
+
+enum class TicketSet {
+    RANDOM,        // Длительности 1..60 минут: много равных, идеальное распределение обычно есть
+    ADVERSARIAL    // Длительности 1..10^6 почти без повторов: точное разбиение найти трудно
+};
+
+const char* ticketSetName(TicketSet set);
+
+// Длительности билетов в порядке постановки в очередь
+std::vector<int> ticketDurations(size_t count, TicketSet set, uint32_t seed);
+
+// Поток посетителей для онлайн-режима очереди: пуассоновские приходы (экспоненциальные
+// интервалы) с длительностями 1..60 минут. Интенсивность подобрана так, чтобы
+// windows окон были заняты в среднем на долю load своего времени.
+struct Arrival {
+    double time;      // Минуты от начала смены
+    int duration;
+};
+
+std::vector<Arrival> poissonArrivals(size_t count, int windows, double load, uint32_t seed);
+
+// Трамвайная сеть: маршруты по routeLength остановок из stopCount общих
+struct TramNetwork {
+    std::vector<std::pair<std::string, std::vector<std::string>>> routes;
+    std::vector<std::string> stops;
+};
+
+TramNetwork tramNetwork(size_t trams, size_t routeLength, size_t stopCount, uint32_t seed);
+
+// Изменение трамвайной сети: трамваи Tram0..Tram<trams-1>, остановки Stop0..Stop<stops-1>.
+// Часть изменений заведомо отклоняется (нет трамвая, позиция вне маршрута, повтор)
+struct TramMutation {
+    enum class Kind { CREATE, DELETE, ADD_STOP, REMOVE_STOP };
+
+    Kind kind;
+    std::string tram;
+    std::string stop;                  // ADD_STOP и REMOVE_STOP
+    size_t position = 0;               // ADD_STOP, с 1
+    std::vector<std::string> route;    // CREATE
+};
+
+// Смесь изменений: ADD_STOP 40%, REMOVE_STOP 30%, CREATE 15%, DELETE 15%
+std::vector<TramMutation> tramMutations(size_t count, size_t trams, size_t stops, uint32_t seed);
+
+// Команды справочника регионов (по одной на строку, без числа команд в начале):
+// CHANGE и RENAME по names названиям вперемешку с ABOUT, ALL <префикс> и HISTORY
+std::string regionCommands(size_t count, size_t names, uint32_t seed);
+
+// Поток CHANGE/RENAME/ABOUT для сравнения справочников: названия и центры заданы
+// номерами в таблицах, чтобы 10^7 операций занимали мало памяти
+struct RegionOps {
+    struct Op {
+        enum class Kind : uint8_t { CHANGE, RENAME, ABOUT };
+
+        Kind kind;
+        uint32_t region;
+        uint32_t other;   // Центр для CHANGE, новое название для RENAME
+    };
+
+    std::vector<std::string> regions;
+    std::vector<std::string> centers;
+    std::vector<Op> ops;
+};
+
+RegionOps regionOps(size_t count, size_t names, uint32_t seed);
+
+// Те же операции текстом команд ex4, по одной на строку, без числа команд в начале
+std::string regionScript(const RegionOps& ops);
+
+}
+
+#endif
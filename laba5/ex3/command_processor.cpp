@@ -0,0 +1,307 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include "command_processor.h"
+#include "network_loader.h"
+#include "../instrumentation.h"
+#include "../tokenizer.h"
+
+using namespace std;
+
+// Число и время выполнения команд, выводятся командой STATS
+instrumentation::CommandStats commandStats;
+
+constexpr tokenizer::Keyword<Command> commandKeywords[] = {
+    {"CREATE_TRAM", Command::CREATE_TRAM},
+    {"DELETE_TRAM", Command::DELETE_TRAM},
+    {"ADD_STOP", Command::ADD_STOP},
+    {"REMOVE_STOP", Command::REMOVE_STOP},
+    {"TRAMS_IN_STOP", Command::TRAMS_IN_STOP},
+    {"STOPS_IN_TRAM", Command::STOPS_IN_TRAM},
+    {"TRAMS", Command::TRAMS},
+    {"ROUTE", Command::ROUTE},
+    {"LOAD", Command::LOAD},
+    {"DUMP", Command::DUMP},
+    {"STATS", Command::STATS},
+    {"EXIT", Command::EXIT}
+};
+
+// Команды без учета регистра; совершенный хеш подбирается при компиляции
+constexpr auto commandTable = tokenizer::makeKeywordTable(commandKeywords, Command::UNKNOWN);
+
+// Функция для преобразования строки в команду
+Command parseCommand(string_view input) {
+    return commandTable.find(input);
+}
+
+void printHelp(ostream& out) {
+    out << "Available commands:\n"
+        << "CREATE_TRAM <name> <stop1> <stop2> ...\n"
+        << "DELETE_TRAM <name>\n"
+        << "ADD_STOP <tram> <stop> <position>\n"
+        << "REMOVE_STOP <tram> <stop>\n"
+        << "TRAMS_IN_STOP <stop>\n"
+        << "STOPS_IN_TRAM <tram>\n"
+        << "TRAMS\n"
+        << "ROUTE <from> <to>\n"
+        << "LOAD <file>\n"
+        << "DUMP <file>\n"
+        << "STATS\n"
+        << "EXIT\n";
+}
+
+// Загрузка сети из файла с выводом итога и ошибок отдельных маршрутов
+void loadFile(const string& path, TramManager& manager, ostream& out, ostream& err) {
+    LoadReport report;
+    string error = loadNetwork(manager, path, report);
+    for (const auto& routeError : report.errors) {
+        err << routeError << "\n";
+    }
+    if (!error.empty()) {
+        err << error << "\n";
+    } else {
+        out << "Loaded " << report.added << " tram(s) from " << path << "\n";
+    }
+}
+
+// Имя команды для счетчика времени
+static string_view commandName(Command cmd) {
+    auto named = find_if(begin(commandKeywords), end(commandKeywords),
+                         [cmd](const auto& keyword) { return keyword.value == cmd; });
+    return named != end(commandKeywords) ? named->name : "UNKNOWN";
+}
+
+bool isQuery(Command cmd) {
+    switch (cmd) {
+        case Command::TRAMS_IN_STOP:
+        case Command::STOPS_IN_TRAM:
+        case Command::TRAMS:
+        case Command::ROUTE:
+        case Command::DUMP:
+        case Command::STATS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void processQuery(Command cmd, istringstream& iss, const TramManager& manager, JourneyPlanner& planner,
+                  ostream& out, ostream& err) {
+    // Время команды попадает в счетчик с ее именем
+    instrumentation::ScopedTimer timer(commandStats[commandName(cmd)]);
+
+    switch(cmd) {
+        case Command::TRAMS_IN_STOP: {
+            string stop;
+            if (!(iss >> stop)) {
+                err << "ERROR: Missing stop name\n";
+                return;
+            }
+            
+            NameView trams = manager.tramsInStop(stop);
+            if (trams.empty()) {
+                out << "No trams in stop " << stop << "\n";
+            } else {
+                out << "Trams in stop " << stop << ": ";
+                for (const auto& tram : trams) {
+                    out << tram << " ";
+                }
+                out << "\n";
+            }
+            break;
+        }
+        
+        case Command::STOPS_IN_TRAM: {
+            string tram;
+            if (!(iss >> tram)) {
+                err << "ERROR: Missing tram name\n";
+                return;
+            }
+            
+            if (manager.findTram(tram) == TramManager::NOT_FOUND) {
+                out << "Tram " << tram << " not found\n";
+            } else {
+                out << "Stops for tram " << tram << ":\n";
+                manager.forEachStopInTram(tram, [&out](const string& stop, NameView trams) {
+                    out << " - " << stop << ": ";
+                    if (trams.empty()) {
+                        out << "no other trams";
+                    } else {
+                        for (const auto& t : trams) {
+                            out << t << " ";
+                        }
+                    }
+                    out << "\n";
+                });
+            }
+            break;
+        }
+        
+        case Command::TRAMS: {
+            if (manager.activeTramCount() == 0) {
+                out << "No trams registered\n";
+            } else {
+                out << "All trams:\n";
+                manager.forEachTram([&out](const string& tram, NameView stops) {
+                    out << " - " << tram << ": ";
+                    for (const auto& stop : stops) {
+                        out << stop << " ";
+                    }
+                    out << "\n";
+                });
+            }
+            break;
+        }
+        
+        case Command::ROUTE: {
+            string from, to;
+            if (!(iss >> from >> to)) {
+                err << "ERROR: Missing stop name\n";
+                return;
+            }
+            
+            vector<JourneyLeg> legs;
+            string error = planner.findRoute(from, to, legs);
+            if (!error.empty()) {
+                err << error << "\n";
+            } else if (legs.empty()) {
+                out << "Already at stop " << from << "\n";
+            } else {
+                size_t totalStops = 0;
+                for (const auto& leg : legs) {
+                    totalStops += leg.stops;
+                }
+                out << "Route from " << from << " to " << to << ": "
+                     << legs.size() - 1 << " transfer(s), " << totalStops << " stop(s)\n";
+                for (const auto& leg : legs) {
+                    out << " - " << manager.tramName(leg.tram) << ": "
+                         << manager.stopName(leg.from) << " -> " << manager.stopName(leg.to)
+                         << " (" << leg.stops << " stop(s))\n";
+                }
+            }
+            break;
+        }
+        
+        case Command::DUMP: {
+            string path;
+            if (!(iss >> path)) {
+                err << "ERROR: Missing file name\n";
+                return;
+            }
+            string error = manager.writeBinary(path);
+            if (!error.empty()) {
+                err << error << "\n";
+            } else {
+                out << "Network saved to " << path << "\n";
+            }
+            break;
+        }
+        
+        case Command::STATS:
+            out << commandStats.report();
+            break;
+        
+        default:
+            break;
+    }
+}
+
+void processCommand(Command cmd, istringstream& iss, TramManager& manager, JourneyPlanner& planner,
+                    ostream& out, ostream& err) {
+    if (isQuery(cmd)) {
+        processQuery(cmd, iss, manager, planner, out, err);
+        return;
+    }
+    instrumentation::ScopedTimer timer(commandStats[commandName(cmd)]);
+
+    switch(cmd) {
+        case Command::CREATE_TRAM: {
+            string tramName;
+            if (!(iss >> tramName)) {
+                err << "ERROR: Missing tram name\n";
+                return;
+            }
+            
+            vector<string> stops;
+            string stop;
+            while (iss >> stop) {
+                stops.push_back(stop);
+            }
+            
+            string error = manager.createTram(tramName, stops);
+            if (!error.empty()) {
+                err << error << "\n";
+            }
+            break;
+        }
+        
+        case Command::DELETE_TRAM: {
+            string tramName;
+            if (!(iss >> tramName)) {
+                err << "ERROR: Missing tram name\n";
+                return;
+            }
+            
+            string error = manager.deleteTram(tramName);
+            if (!error.empty()) {
+                err << error << "\n";
+            }
+            break;
+        }
+        
+        case Command::ADD_STOP: {
+            string tramName, stop;
+            if (!(iss >> tramName)) {
+                err << "ERROR: Missing tram name\n";
+                return;
+            }
+            if (!(iss >> stop)) {
+                err << "ERROR: Missing stop name\n";
+                return;
+            }
+            long long position;
+            if (!(iss >> position)) {
+                err << "ERROR: Missing stop position\n";
+                return;
+            }
+            
+            string error = manager.addStop(tramName, stop, position > 0 ? static_cast<size_t>(position) : 0);
+            if (!error.empty()) {
+                err << error << "\n";
+            }
+            break;
+        }
+        
+        case Command::REMOVE_STOP: {
+            string tramName, stop;
+            if (!(iss >> tramName)) {
+                err << "ERROR: Missing tram name\n";
+                return;
+            }
+            if (!(iss >> stop)) {
+                err << "ERROR: Missing stop name\n";
+                return;
+            }
+            
+            string error = manager.removeStop(tramName, stop);
+            if (!error.empty()) {
+                err << error << "\n";
+            }
+            break;
+        }
+        
+        case Command::LOAD: {
+            string path;
+            if (!(iss >> path)) {
+                err << "ERROR: Missing file name\n";
+                return;
+            }
+            loadFile(path, manager, out, err);
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
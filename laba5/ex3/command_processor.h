@@ -0,0 +1,49 @@
+// command_processor.h
+#ifndef COMMAND_PROCESSOR_H
+#define COMMAND_PROCESSOR_H
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include "tram_manager.h"
+#include "journey_planner.h"
+
+// Enum класс для представления команд
+enum class Command {
+    CREATE_TRAM,
+    DELETE_TRAM,
+    ADD_STOP,
+    REMOVE_STOP,
+    TRAMS_IN_STOP,
+    STOPS_IN_TRAM,
+    TRAMS,
+    ROUTE,
+    LOAD,
+    DUMP,
+    STATS,
+    EXIT,
+    UNKNOWN
+};
+
+// Функция для преобразования строки в команду
+Command parseCommand(std::string_view input);
+
+void printHelp(std::ostream& out);
+
+// Загрузка сети из файла с выводом итога и ошибок отдельных маршрутов
+void loadFile(const std::string& path, TramManager& manager, std::ostream& out, std::ostream& err);
+
+// Команды, которые только читают сеть: их можно выполнять на неизменяемом
+// снимке ConcurrentTramManager
+bool isQuery(Command cmd);
+
+// Выполнение читающей команды (isQuery); ответы пишутся в out, ошибки в err
+void processQuery(Command cmd, std::istringstream& iss, const TramManager& manager, JourneyPlanner& planner,
+                  std::ostream& out, std::ostream& err);
+
+// Выполнение команды с аргументами из iss; ответы пишутся в out, ошибки в err.
+// Используется и консольным main, и сервером (server/), где оба потока - ответ клиенту.
+void processCommand(Command cmd, std::istringstream& iss, TramManager& manager, JourneyPlanner& planner,
+                    std::ostream& out, std::ostream& err);
+
+#endif
@@ -0,0 +1,153 @@
+// concurrent_tram_manager.cpp
+#include "concurrent_tram_manager.h"
+#include <algorithm>
+
+namespace {
+
+// Начальная ячейка читателя: у каждого потока своя, пока потоков не больше MAX_READERS
+size_t readerHint() {
+    static std::atomic<size_t> nextReader{0};
+    thread_local size_t hint = nextReader.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+}
+
+ConcurrentTramManager::ReadGuard::ReadGuard(const ConcurrentTramManager& manager) : owner(manager) {
+    // Занимаем свободную ячейку, объявляем эпоху и только затем читаем указатель:
+    // писатель, увидевший эпоху, не освободит снимок, который мы можем загрузить.
+    // Если за один проход свободной ячейки нет, читатель учитывается общим счетчиком,
+    // а не крутится в ожидании.
+    uint64_t epoch = owner.epoch_.load();
+    size_t start = readerHint() % MAX_READERS;
+    slot = MAX_READERS;
+    for (size_t i = 0; i < MAX_READERS; ++i) {
+        size_t candidate = (start + i) % MAX_READERS;
+        uint64_t expected = 0;
+        if (owner.readers_[candidate].epoch.compare_exchange_strong(expected, epoch)) {
+            slot = candidate;
+            break;
+        }
+    }
+    if (slot == MAX_READERS) {
+        owner.overflow_readers_.fetch_add(1);
+    }
+    snapshot = owner.current_.load();
+}
+
+ConcurrentTramManager::ReadGuard::~ReadGuard() {
+    if (slot == MAX_READERS) {
+        owner.overflow_readers_.fetch_sub(1, std::memory_order_release);
+    } else {
+        owner.readers_[slot].epoch.store(0, std::memory_order_release);
+    }
+}
+
+ConcurrentTramManager::ConcurrentTramManager() {
+    TramManager* empty = new TramManager();
+    empty->freeze();
+    current_.store(empty);
+}
+
+ConcurrentTramManager::~ConcurrentTramManager() {
+    for (auto& [snapshot, epoch] : retired_) {
+        delete snapshot;
+    }
+    delete current_.load();
+}
+
+std::vector<std::string> ConcurrentTramManager::getTramsInStop(const std::string& stop) const {
+    return read([&stop](const TramManager& snapshot) { return snapshot.getTramsInStop(stop); });
+}
+
+std::vector<std::pair<std::string, std::set<std::string>>>
+ConcurrentTramManager::getStopsInTram(const std::string& tram) const {
+    return read([&tram](const TramManager& snapshot) { return snapshot.getStopsInTram(tram); });
+}
+
+std::map<std::string, std::vector<std::string>> ConcurrentTramManager::getAllTrams() const {
+    return read([](const TramManager& snapshot) { return snapshot.getAllTrams(); });
+}
+
+uint64_t ConcurrentTramManager::version() const {
+    return read([](const TramManager& snapshot) { return snapshot.version(); });
+}
+
+void ConcurrentTramManager::submit(const std::string& name, std::vector<std::string> stops) {
+    std::lock_guard<std::mutex> guard(pending_lock_);
+    pending_.emplace_back(name, std::move(stops));
+}
+
+std::vector<std::string> ConcurrentTramManager::publish() {
+    std::vector<std::pair<std::string, std::vector<std::string>>> batch;
+    {
+        std::lock_guard<std::mutex> guard(pending_lock_);
+        batch.swap(pending_);
+    }
+    return apply(batch);
+}
+
+std::string ConcurrentTramManager::createTram(const std::string& name, const std::vector<std::string>& stops) {
+    std::vector<std::pair<std::string, std::vector<std::string>>> batch;
+    batch.emplace_back(name, stops);
+    std::vector<std::string> errors = apply(batch);
+    return errors.empty() ? "" : errors.front();
+}
+
+ConcurrentTramManager::Update::Update(ConcurrentTramManager& owner)
+    : owner_(&owner), lock_(owner.publish_lock_), draft_(new TramManager(*owner.current_.load())) {}
+
+void ConcurrentTramManager::Update::commit() {
+    draft_->freeze();
+    owner_->install(draft_.release());
+    lock_.unlock();
+}
+
+// Новый снимок - копия текущего с маршрутами пачки; публикуется одной заменой указателя
+std::vector<std::string> ConcurrentTramManager::apply(
+        std::vector<std::pair<std::string, std::vector<std::string>>>& batch) {
+    std::vector<std::string> errors;
+    if (batch.empty()) {
+        return errors;
+    }
+
+    Update update(*this);
+    for (const auto& [name, stops] : batch) {
+        std::string error = update.network().createTram(name, stops);
+        if (!error.empty()) {
+            errors.push_back(std::move(error));
+        }
+    }
+    update.commit();
+    return errors;
+}
+
+// После замены указателя эпоха увеличивается: читатели с эпохой не меньше
+// retireEpoch уже загрузят новый снимок
+void ConcurrentTramManager::install(const TramManager* next) {
+    const TramManager* old = current_.load();
+    current_.store(next);
+    uint64_t retireEpoch = epoch_.fetch_add(1) + 1;
+    retired_.emplace_back(old, retireEpoch);
+    reclaim();
+}
+
+// Освобождение снимков, которые не может держать ни один активный читатель
+void ConcurrentTramManager::reclaim() {
+    if (overflow_readers_.load() != 0) {
+        return;
+    }
+    uint64_t oldestActive = UINT64_MAX;
+    for (const auto& reader : readers_) {
+        uint64_t epoch = reader.epoch.load();
+        if (epoch != 0) {
+            oldestActive = std::min(oldestActive, epoch);
+        }
+    }
+    auto stillUsed = std::partition(retired_.begin(), retired_.end(),
+                                    [oldestActive](const auto& item) { return item.second > oldestActive; });
+    for (auto it = stillUsed; it != retired_.end(); ++it) {
+        delete it->first;
+    }
+    retired_.erase(stillUsed, retired_.end());
+}
@@ -0,0 +1,105 @@
+// concurrent_tram_manager.h
+#ifndef CONCURRENT_TRAM_MANAGER_H
+#define CONCURRENT_TRAM_MANAGER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "tram_manager.h"
+
+// Сеть для многопоточного чтения. Читатели работают с неизменяемым снимком
+// TramManager: вход в чтение - запись эпохи в свою ячейку и загрузка указателя,
+// без блокировок и ожиданий. Писатели копят маршруты в пачку, publish() строит
+// новый снимок на копии текущего и атомарно подменяет указатель. Старый снимок
+// удаляется, когда все читатели, которые могли его видеть, вышли из чтения
+// (освобождение по эпохам).
+class ConcurrentTramManager {
+public:
+    // Произвольные изменения сети: черновик - копия текущего снимка, которую
+    // commit() публикует целиком. Пока изменение существует, оно держит блокировку
+    // писателей, поэтому создается, публикуется и удаляется в одном потоке.
+    // Изменение без commit() отбрасывается.
+    class Update {
+    public:
+        explicit Update(ConcurrentTramManager& owner);
+        Update(Update&&) = default;
+
+        TramManager& network() { return *draft_; }
+        void commit();
+
+    private:
+        ConcurrentTramManager* owner_;
+        std::unique_lock<std::mutex> lock_;
+        std::unique_ptr<TramManager> draft_;
+    };
+
+    ConcurrentTramManager();
+    ~ConcurrentTramManager();
+
+    ConcurrentTramManager(const ConcurrentTramManager&) = delete;
+    ConcurrentTramManager& operator=(const ConcurrentTramManager&) = delete;
+
+    // Чтение: read(snapshot) вызывается с текущим снимком; ссылки и представления
+    // снимка действительны только внутри read
+    template <typename Read>
+    auto read(Read reader) const {
+        ReadGuard guard(*this);
+        return reader(*guard.snapshot);
+    }
+
+    std::vector<std::string> getTramsInStop(const std::string& stop) const;
+    std::vector<std::pair<std::string, std::set<std::string>>> getStopsInTram(const std::string& tram) const;
+    std::map<std::string, std::vector<std::string>> getAllTrams() const;
+    uint64_t version() const;
+
+    // Запись: маршрут попадает в пачку и становится виден после publish()
+    void submit(const std::string& name, std::vector<std::string> stops);
+    // Применение пачки и публикация снимка; возвращает ошибки отклоненных маршрутов
+    std::vector<std::string> publish();
+    // Немедленное добавление одного маршрута
+    std::string createTram(const std::string& name, const std::vector<std::string>& stops);
+
+private:
+    static constexpr size_t MAX_READERS = 128;
+
+    // Эпоха, в которую читатель вошел в чтение (0 - ячейка свободна);
+    // отдельная строка кэша на ячейку, чтобы читатели не мешали друг другу
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    struct ReadGuard {
+        const ConcurrentTramManager& owner;
+        size_t slot;                    // MAX_READERS - читатель учтен в overflow_readers_
+        const TramManager* snapshot;
+
+        explicit ReadGuard(const ConcurrentTramManager& manager);
+        ~ReadGuard();
+    };
+
+    mutable std::array<ReaderSlot, MAX_READERS> readers_;
+    // Читатели, которым не хватило ячеек (больше MAX_READERS одновременно). Их эпохи
+    // неизвестны, поэтому пока счетчик не ноль, снятые снимки не освобождаются.
+    mutable std::atomic<size_t> overflow_readers_{0};
+    std::atomic<const TramManager*> current_;
+    std::atomic<uint64_t> epoch_{1};
+
+    std::mutex pending_lock_;
+    std::vector<std::pair<std::string, std::vector<std::string>>> pending_;
+
+    // Писатели публикуют снимки по очереди; снятые снимки ждут освобождения
+    std::mutex publish_lock_;
+    std::vector<std::pair<const TramManager*, uint64_t>> retired_;
+
+    std::vector<std::string> apply(std::vector<std::pair<std::string, std::vector<std::string>>>& batch);
+    // Замена снимка; вызывается под publish_lock_
+    void install(const TramManager* next);
+    void reclaim();
+};
+
+#endif
@@ -0,0 +1,247 @@
+// journey_planner.cpp
+#include "journey_planner.h"
+#include <algorithm>
+
+void JourneyPlanner::Frontier::reset() {
+    for (uint32_t tram : order) {
+        level[tram] = 0;
+    }
+    order.clear();
+    starts.assign(1, 0);
+}
+
+// Граф пересадок: трамваи соседние, если у них есть общая остановка
+void JourneyPlanner::buildGraph() {
+    size_t trams = manager_->tramCount();
+    std::vector<uint32_t> seen(trams, INF);
+    graph_offsets_.assign(1, 0);
+    graph_trams_.clear();
+    for (uint32_t tram = 0; tram < trams; ++tram) {
+        seen[tram] = tram;
+        for (uint32_t stop : manager_->routeStops(tram)) {
+            for (uint32_t other : manager_->tramsAtStop(stop)) {
+                if (seen[other] != tram) {
+                    seen[other] = tram;
+                    graph_trams_.push_back(other);
+                }
+            }
+        }
+        graph_offsets_.push_back(static_cast<uint32_t>(graph_trams_.size()));
+    }
+    graph_version_ = manager_->version();
+}
+
+// Подгонка графа и рабочих массивов под текущую сеть
+void JourneyPlanner::prepare() {
+    if (graph_version_ != manager_->version()) {
+        buildGraph();
+    }
+    size_t stops = manager_->stopCount();
+    if (best_.size() < stops) {
+        best_.resize(stops, INF);
+        prev_.resize(stops, INF);
+        last_.resize(stops, -1);
+        mark_stamp_.resize(stops, 0);
+    }
+    size_t trams = manager_->tramCount();
+    if (forward_.level.size() < trams) {
+        forward_.level.resize(trams, 0);
+        backward_.level.resize(trams, 0);
+    }
+}
+
+// Сброс меток, выставленных предыдущим запросом
+void JourneyPlanner::reset() {
+    for (uint32_t stop : touched_) {
+        best_[stop] = INF;
+        prev_[stop] = INF;
+        last_[stop] = -1;
+    }
+    touched_.clear();
+    log_.clear();
+    forward_.reset();
+    backward_.reset();
+}
+
+// Первый уровень поиска - трамваи, проходящие через остановку
+void JourneyPlanner::seed(Frontier& frontier, uint32_t stop) {
+    for (uint32_t tram : manager_->tramsAtStop(stop)) {
+        frontier.level[tram] = 1;
+        frontier.order.push_back(tram);
+    }
+    frontier.starts.push_back(frontier.order.size());
+}
+
+// Раскрытие следующего уровня целиком. Возвращает наименьшее число поездок
+// через трамваи, достигнутые с обеих сторон, или INF, если встречи нет
+uint32_t JourneyPlanner::expand(Frontier& frontier, const Frontier& other) {
+    uint32_t depth = static_cast<uint32_t>(frontier.levels()) + 1;
+    uint32_t trips = INF;
+    for (size_t i = frontier.starts[depth - 2]; i < frontier.starts[depth - 1]; ++i) {
+        uint32_t tram = frontier.order[i];
+        for (uint32_t k = graph_offsets_[tram]; k < graph_offsets_[tram + 1]; ++k) {
+            uint32_t next = graph_trams_[k];
+            if (frontier.level[next] != 0) continue;
+            frontier.level[next] = depth;
+            frontier.order.push_back(next);
+            if (other.level[next] != 0) {
+                trips = std::min(trips, depth + other.level[next] - 1);
+            }
+        }
+    }
+    frontier.starts.push_back(frontier.order.size());
+    return trips;
+}
+
+// Наименьшее число поездок: двунаправленный поиск в ширину, каждый раз
+// раскрывается меньший из последних уровней
+uint32_t JourneyPlanner::countTrips(uint32_t origin, uint32_t target) {
+    seed(forward_, origin);
+    seed(backward_, target);
+    for (uint32_t tram : forward_.order) {
+        if (backward_.level[tram] != 0) return 1;
+    }
+
+    while (true) {
+        size_t forwardSize = forward_.levelSize(forward_.levels());
+        size_t backwardSize = backward_.levelSize(backward_.levels());
+        if (forwardSize == 0 || backwardSize == 0) return INF;
+        uint32_t trips = (forwardSize <= backwardSize) ? expand(forward_, backward_)
+                                                       : expand(backward_, forward_);
+        if (trips != INF) return trips;
+    }
+}
+
+void JourneyPlanner::improve(uint32_t stop, uint32_t round, uint32_t tram, uint32_t board, uint32_t label) {
+    if (best_[stop] == INF) {
+        touched_.push_back(stop);
+    }
+    best_[stop] = label;
+    log_.push_back({stop, round, tram, board, label, last_[stop]});
+    last_[stop] = static_cast<int32_t>(log_.size() - 1);
+    if (mark_stamp_[stop] != stamp_) {
+        mark_stamp_[stop] = stamp_;
+        improved_.push_back(stop);
+    }
+}
+
+// Проход по маршруту трамвая в обе стороны: посадка возможна на любой остановке
+// с меткой предыдущего раунда, поездка добавляет по перегону на остановку
+void JourneyPlanner::scanTram(uint32_t tram, uint32_t round) {
+    IdRange route = manager_->routeStops(tram);
+    size_t n = route.size();
+    if (arrival_.size() < n) {
+        arrival_.resize(n);
+        boarding_.resize(n);
+    }
+
+    uint32_t run = INF, runBoard = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (run != INF) ++run;
+        if (prev_[route[i]] < run) {
+            run = prev_[route[i]];
+            runBoard = static_cast<uint32_t>(i);
+        }
+        arrival_[i] = run;
+        boarding_[i] = runBoard;
+    }
+
+    run = INF;
+    for (size_t i = n; i-- > 0;) {
+        if (run != INF) ++run;
+        if (prev_[route[i]] < run) {
+            run = prev_[route[i]];
+            runBoard = static_cast<uint32_t>(i);
+        }
+        if (run < arrival_[i]) {
+            arrival_[i] = run;
+            boarding_[i] = runBoard;
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (boarding_[i] != i && arrival_[i] < best_[route[i]]) {
+            improve(route[i], round, tram, route[boarding_[i]], arrival_[i]);
+        }
+    }
+}
+
+std::string JourneyPlanner::findRoute(const std::string& from, const std::string& to, std::vector<JourneyLeg>& legs) {
+    legs.clear();
+    // Остановка без трамваев (например, из отклоненного маршрута) считается отсутствующей
+    uint32_t origin = manager_->findStop(from);
+    if (origin == TramManager::NOT_FOUND || manager_->tramsAtStop(origin).size() == 0) {
+        return "ERROR: Stop '" + from + "' not found";
+    }
+    uint32_t target = manager_->findStop(to);
+    if (target == TramManager::NOT_FOUND || manager_->tramsAtStop(target).size() == 0) {
+        return "ERROR: Stop '" + to + "' not found";
+    }
+    if (origin == target) {
+        return "";
+    }
+
+    prepare();
+    reset();
+    uint32_t trips = countTrips(origin, target);
+    if (trips == INF) {
+        return "ERROR: No route from '" + from + "' to '" + to + "'";
+    }
+
+    best_[origin] = 0;
+    prev_[origin] = 0;
+    touched_.push_back(origin);
+
+    // Трамвай может стоять j-м на кратчайшем пути, только если он на уровне j
+    // от начала и на уровне trips + 1 - j от конца. Уровни глубже раскрытых
+    // означают, что трамвай с этой стороны еще не достигнут
+    auto onLevel = [](const Frontier& frontier, uint32_t tram, uint32_t depth) {
+        return (depth <= frontier.levels()) ? frontier.level[tram] == depth : frontier.level[tram] == 0;
+    };
+
+    for (uint32_t round = 1; round <= trips; ++round) {
+        uint32_t fromEnd = trips + 1 - round;
+        bool forwardKnown = round <= forward_.levels();
+        bool backwardKnown = fromEnd <= backward_.levels();
+        const Frontier& side = (forwardKnown && (!backwardKnown ||
+                                forward_.levelSize(round) <= backward_.levelSize(fromEnd))) ? forward_ : backward_;
+        uint32_t depth = (&side == &forward_) ? round : fromEnd;
+
+        if (++stamp_ == 0) {
+            std::fill(mark_stamp_.begin(), mark_stamp_.end(), 0);
+            stamp_ = 1;
+        }
+        improved_.clear();
+        for (size_t i = side.starts[depth - 1]; i < side.starts[depth]; ++i) {
+            uint32_t tram = side.order[i];
+            if (onLevel(forward_, tram, round) && onLevel(backward_, tram, fromEnd)) {
+                scanTram(tram, round);
+            }
+        }
+
+        // Метки раунда становятся доступны для посадки только в следующем раунде
+        for (uint32_t stop : improved_) {
+            prev_[stop] = best_[stop];
+        }
+    }
+
+    // Восстановление пути: для каждой остановки берется последнее улучшение
+    // не позже текущего раунда, затем переход к остановке посадки
+    uint32_t round = trips;
+    uint32_t stop = target;
+    while (stop != origin) {
+        int32_t index = last_[stop];
+        while (log_[index].round > round) {
+            index = log_[index].previous;
+        }
+        const Improvement& step = log_[index];
+        legs.push_back({step.tram, step.board, stop, step.label});
+        stop = step.board;
+        round = step.round - 1;
+    }
+    std::reverse(legs.begin(), legs.end());
+    for (size_t i = legs.size(); i-- > 1;) {
+        legs[i].stops -= legs[i - 1].stops;
+    }
+    return "";
+}
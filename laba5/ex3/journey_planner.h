@@ -0,0 +1,93 @@
+// journey_planner.h
+#ifndef JOURNEY_PLANNER_H
+#define JOURNEY_PLANNER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "tram_manager.h"
+
+// Участок поездки: на трамвае tram от остановки from до остановки to
+struct JourneyLeg {
+    uint32_t tram;
+    uint32_t from;
+    uint32_t to;
+    uint32_t stops;   // Количество перегонов на участке
+};
+
+// Поиск маршрута с наименьшим числом пересадок, при равенстве - с наименьшим
+// числом остановок; трамваи ходят в обе стороны.
+//
+// Сначала двунаправленный поиск в ширину по графу пересадок между трамваями
+// находит наименьшее число поездок R. Затем раунды в духе RAPTOR считают
+// наименьшее число перегонов, причем в раунде j просматриваются только трамваи,
+// которые могут стоять j-ми на пути из R поездок. Граф пересадок строится
+// заново только после изменения сети, рабочие массивы переиспользуются.
+class JourneyPlanner {
+public:
+    explicit JourneyPlanner(const TramManager& manager) : manager_(&manager) {}
+
+    // Переход на другой экземпляр сети - копию прежней с изменениями, например
+    // новый снимок ConcurrentTramManager. Граф пересадок перестраивается, только
+    // если версия сети отличается от той, по которой он построен
+    void attach(const TramManager& manager) { manager_ = &manager; }
+
+    std::string findRoute(const std::string& from, const std::string& to, std::vector<JourneyLeg>& legs);
+
+private:
+    static constexpr uint32_t INF = UINT32_MAX;
+
+    // Улучшение метки остановки в некотором раунде
+    struct Improvement {
+        uint32_t stop;
+        uint32_t round;
+        uint32_t tram;
+        uint32_t board;       // Остановка посадки
+        uint32_t label;       // Число перегонов от начальной остановки
+        int32_t previous;     // Предыдущее улучшение этой же остановки
+    };
+
+    // Уровни поиска в ширину по трамваям с одной стороны
+    struct Frontier {
+        std::vector<uint32_t> level;    // Уровень трамвая (0 - не достигнут)
+        std::vector<uint32_t> order;    // Трамваи в порядке обнаружения
+        std::vector<size_t> starts;     // Начало каждого уровня в order
+
+        void reset();
+        size_t levels() const { return starts.size() - 1; }
+        size_t levelSize(size_t depth) const { return starts[depth] - starts[depth - 1]; }
+    };
+
+    const TramManager* manager_;
+
+    // Граф пересадок в формате CSR: соседи трамвая t - graph_trams_[graph_offsets_[t]..graph_offsets_[t + 1])
+    std::vector<uint32_t> graph_offsets_;
+    std::vector<uint32_t> graph_trams_;
+    uint64_t graph_version_ = UINT64_MAX;
+
+    Frontier forward_, backward_;
+
+    std::vector<uint32_t> best_;       // Лучшая метка с учетом текущего раунда
+    std::vector<uint32_t> prev_;       // Метка на конец предыдущего раунда
+    std::vector<int32_t> last_;        // Последнее улучшение остановки
+    std::vector<uint32_t> touched_;    // Остановки с конечной меткой (для сброса)
+    std::vector<Improvement> log_;
+
+    std::vector<uint32_t> improved_;   // Остановки, улучшенные в текущем раунде
+    std::vector<uint32_t> mark_stamp_;
+    uint32_t stamp_ = 0;
+
+    std::vector<uint32_t> arrival_;    // Лучшая метка вдоль маршрута при проходе
+    std::vector<uint32_t> boarding_;   // Позиция посадки для этой метки
+
+    void buildGraph();
+    void prepare();
+    void reset();
+    void seed(Frontier& frontier, uint32_t stop);
+    uint32_t expand(Frontier& frontier, const Frontier& other);
+    uint32_t countTrips(uint32_t origin, uint32_t target);
+    void scanTram(uint32_t tram, uint32_t round);
+    void improve(uint32_t stop, uint32_t round, uint32_t tram, uint32_t board, uint32_t label);
+};
+
+#endif
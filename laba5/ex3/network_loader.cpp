@@ -0,0 +1,125 @@
+// network_loader.cpp
+#include "network_loader.h"
+#include <cstring>
+#include <vector>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Файл, отображенный в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            size_ = static_cast<size_t>(info.st_size);
+            if (size_ == 0) {
+                valid_ = true;
+            } else {
+                void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    data_ = static_cast<const char*>(data);
+                    valid_ = true;
+                    madvise(data, size_, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return valid_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool valid_ = false;
+};
+
+// Маршруты передаются менеджеру пачками, чтобы не держать представление всего файла
+const size_t ROUTES_PER_BATCH = 1 << 18;
+
+std::string_view trim(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '\r')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+    return std::string_view(begin, static_cast<size_t>(end - begin));
+}
+
+// Разбор текстового файла без копирования: поля - string_view в отображение файла
+void loadText(TramManager& manager, const char* data, size_t size, LoadReport& report) {
+    std::vector<RouteRecord> routes;
+    std::vector<std::string_view> stops;
+    routes.reserve(ROUTES_PER_BATCH);
+
+    const char* pos = data;
+    const char* end = data + size;
+    size_t line = 0;
+    while (pos < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+        if (!lineEnd) lineEnd = end;
+        ++line;
+
+        std::string_view whole = trim(pos, lineEnd);
+        if (!whole.empty() && whole.front() != '#') {
+            const char* field = whole.data();
+            const char* fieldsEnd = whole.data() + whole.size();
+            const char* comma = static_cast<const char*>(std::memchr(field, ',', whole.size()));
+            if (!comma) comma = fieldsEnd;
+            std::string_view name = trim(field, comma);
+
+            uint32_t first = static_cast<uint32_t>(stops.size());
+            while (comma < fieldsEnd) {
+                field = comma + 1;
+                comma = static_cast<const char*>(std::memchr(field, ',', static_cast<size_t>(fieldsEnd - field)));
+                if (!comma) comma = fieldsEnd;
+                std::string_view stop = trim(field, comma);
+                if (!stop.empty()) stops.push_back(stop);
+            }
+
+            if (name.empty()) {
+                report.errors.push_back("ERROR: line " + std::to_string(line) + ": Missing tram name");
+                stops.resize(first);
+            } else {
+                routes.push_back({name, first, static_cast<uint32_t>(stops.size()), line});
+            }
+
+            if (routes.size() == ROUTES_PER_BATCH) {
+                manager.addRoutes(routes, stops, report);
+                routes.clear();
+                stops.clear();
+            }
+        }
+        pos = lineEnd + 1;
+    }
+    if (!routes.empty()) {
+        manager.addRoutes(routes, stops, report);
+    }
+}
+
+}
+
+std::string loadNetwork(TramManager& manager, const std::string& path, LoadReport& report) {
+    MappedFile file(path);
+    if (!file.valid()) {
+        return "ERROR: Cannot open '" + path + "'";
+    }
+    if (TramManager::isBinaryImage(file.data(), file.size())) {
+        return manager.readBinary(file.data(), file.size(), report);
+    }
+    loadText(manager, file.data(), file.size(), report);
+    return "";
+}
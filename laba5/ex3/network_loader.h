@@ -0,0 +1,16 @@
+// network_loader.h
+#ifndef NETWORK_LOADER_H
+#define NETWORK_LOADER_H
+
+#include <string>
+#include "tram_manager.h"
+
+// Загрузка сети из файла. Текстовый формат - по маршруту на строку:
+//     <tram>,<stop1>,<stop2>,...
+// пробелы вокруг полей игнорируются, пустые строки и строки с '#' пропускаются.
+// Файл, записанный командой DUMP, распознается по сигнатуре и читается целиком.
+// Возвращает пустую строку или описание ошибки открытия/чтения файла;
+// ошибки отдельных маршрутов попадают в report.
+std::string loadNetwork(TramManager& manager, const std::string& path, LoadReport& report);
+
+#endif
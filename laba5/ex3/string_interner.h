@@ -0,0 +1,148 @@
+// string_interner.h
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+// Отображение строк в плотные 32-битные номера. Каждая строка хранится один раз.
+// Поиск - открытая адресация с линейным пробированием: ячейка хранит старшие
+// 32 бита хеша и номер + 1 (0 - пустая ячейка), строки сравниваются только
+// при совпадении хешей.
+class StringInterner {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    // Номер строки; новая строка получает следующий свободный номер
+    uint32_t intern(std::string_view name) {
+        uint64_t hash = hashName(name);
+        size_t slot = findSlot(name, hash);
+        if (slots_.size() && slots_[slot] != 0) {
+            return static_cast<uint32_t>(slots_[slot]) - 1;
+        }
+        uint32_t id = static_cast<uint32_t>(names_.size());
+        names_.emplace_back(name);
+        if ((names_.size() + 1) * 2 > slots_.size()) {
+            grow(slots_.empty() ? 16 : slots_.size() * 2);
+            slot = findSlot(name, hash);
+        }
+        slots_[slot] = makeSlot(hash, id);
+        return id;
+    }
+
+    // Номера для массива строк. Поиск идет конвейером: для строки i + 2 * AHEAD
+    // заранее подгружается ячейка таблицы, для строки i + AHEAD - сама строка,
+    // поэтому промахи кэша разных строк перекрываются
+    void internAll(const std::vector<std::string_view>& names, std::vector<uint32_t>& ids) {
+        constexpr size_t AHEAD = 8;
+        size_t count = names.size();
+        ids.resize(count);
+        std::vector<uint64_t> hashes(count);
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = hashName(names[i]);
+        }
+        if (slots_.empty()) grow(16);
+        size_t mask = slots_.size() - 1;
+        for (size_t i = 0; i < count; ++i) {
+            if (i + 2 * AHEAD < count) {
+                __builtin_prefetch(&slots_[static_cast<size_t>(hashes[i + 2 * AHEAD]) & mask]);
+            }
+            if (i + AHEAD < count) {
+                uint64_t value = slots_[static_cast<size_t>(hashes[i + AHEAD]) & mask];
+                if (value != 0) __builtin_prefetch(&names_[static_cast<uint32_t>(value) - 1]);
+            }
+            size_t slot = findSlot(names[i], hashes[i]);
+            if (slots_[slot] == 0) {
+                if ((names_.size() + 2) * 2 > slots_.size()) {
+                    grow(slots_.size() * 2);
+                    mask = slots_.size() - 1;
+                    slot = findSlot(names[i], hashes[i]);
+                }
+                slots_[slot] = makeSlot(hashes[i], static_cast<uint32_t>(names_.size()));
+                names_.emplace_back(names[i]);
+            }
+            ids[i] = static_cast<uint32_t>(slots_[slot]) - 1;
+        }
+    }
+
+    // Номер строки или NOT_FOUND, если строка не встречалась
+    uint32_t find(std::string_view name) const {
+        if (slots_.empty()) return NOT_FOUND;
+        size_t slot = findSlot(name, hashName(name));
+        return slots_[slot] ? static_cast<uint32_t>(slots_[slot]) - 1 : NOT_FOUND;
+    }
+
+    const std::string& name(uint32_t id) const {
+        return names_[id];
+    }
+
+    size_t size() const {
+        return names_.size();
+    }
+
+    // Подготовка таблицы к указанному общему числу строк
+    void reserve(size_t count) {
+        size_t capacity = slots_.empty() ? 16 : slots_.size();
+        while ((count + 1) * 2 > capacity) capacity *= 2;
+        if (capacity != slots_.size()) grow(capacity);
+    }
+
+private:
+    std::deque<std::string> names_;
+    std::vector<uint64_t> slots_;
+
+    static uint64_t hashName(std::string_view name) {
+        uint64_t hash = 0x9e3779b97f4a7c15ULL ^ name.size();
+        const char* pos = name.data();
+        size_t left = name.size();
+        for (; left >= 8; pos += 8, left -= 8) {
+            uint64_t word;
+            std::memcpy(&word, pos, 8);
+            hash = (hash ^ word) * 0xbf58476d1ce4e5b9ULL;
+            hash ^= hash >> 29;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, pos, left);
+        hash = (hash ^ tail) * 0x94d049bb133111ebULL;
+        return hash ^ (hash >> 32);
+    }
+
+    static uint64_t makeSlot(uint64_t hash, uint32_t id) {
+        return (hash & 0xffffffff00000000ULL) | (uint64_t(id) + 1);
+    }
+
+    // Ячейка со строкой name или первая пустая ячейка на ее пути
+    size_t findSlot(std::string_view name, uint64_t hash) const {
+        if (slots_.empty()) return 0;
+        size_t mask = slots_.size() - 1;
+        uint64_t tag = hash & 0xffffffff00000000ULL;
+        for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+            uint64_t value = slots_[slot];
+            if (value == 0) return slot;
+            if ((value & 0xffffffff00000000ULL) == tag && names_[static_cast<uint32_t>(value) - 1] == name) {
+                return slot;
+            }
+        }
+    }
+
+    void grow(size_t capacity) {
+        std::vector<uint64_t> old;
+        old.swap(slots_);
+        slots_.assign(capacity, 0);
+        size_t mask = capacity - 1;
+        for (uint64_t value : old) {
+            if (value == 0) continue;
+            uint32_t id = static_cast<uint32_t>(value) - 1;
+            uint64_t hash = hashName(names_[id]);
+            size_t slot = static_cast<size_t>(hash) & mask;
+            while (slots_[slot] != 0) slot = (slot + 1) & mask;
+            slots_[slot] = value;
+        }
+    }
+};
+
+#endif
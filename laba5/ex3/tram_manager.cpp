@@ -2,6 +2,184 @@
 #include "tram_manager.h"
 #include <algorithm>
 #include <set>
+#include <cstdio>
+#include <cstring>
+
+// Номер остановки; для новой остановки заводится пустой список трамваев
+uint32_t TramManager::internStop(std::string_view stop) {
+    uint32_t id = stops_.intern(stop);
+    if (id == stop_trams_.size()) {
+        stop_trams_.emplace_back();
+        stop_marks_.push_back(0);
+    }
+    return id;
+}
+
+// 64-битный отпечаток последовательности номеров остановок (порядок важен)
+uint64_t TramManager::routeFingerprint(IdRange ids) {
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ ids.size();
+    for (uint32_t id : ids) {
+        hash ^= id + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        // Перемешивание splitmix64
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+    }
+    return hash;
+}
+
+// Точное сравнение маршрута трамвая с последовательностью номеров остановок
+bool TramManager::sameRoute(uint32_t tram, const std::vector<uint32_t>& ids) const {
+    IdRange route = routeStops(tram);
+    return std::equal(route.begin(), route.end(), ids.begin(), ids.end());
+}
+
+// Начало проверки маршрута: метки остановок предыдущей проверки становятся недействительны
+void TramManager::beginRoute() {
+    route_ids_.clear();
+    if (++mark_generation_ == 0) {
+        std::fill(stop_marks_.begin(), stop_marks_.end(), 0);
+        mark_generation_ = 1;
+    }
+}
+
+// Добавление остановки к проверяемому маршруту; false, если остановка уже встречалась
+bool TramManager::addRouteStop(uint32_t id) {
+    if (stop_marks_[id] == mark_generation_) {
+        return false;
+    }
+    stop_marks_[id] = mark_generation_;
+    route_ids_.push_back(id);
+    return true;
+}
+
+uint32_t TramManager::findTram(const std::string& tram) const {
+    uint32_t id = trams_.find(tram);
+    return (id != NOT_FOUND && routes_[id].size != 0) ? id : NOT_FOUND;
+}
+
+// Проверка названия и дубликата маршрута; пустая строка, если маршрут можно добавить
+std::string TramManager::checkNewRoute(std::string_view name, uint64_t fingerprint) const {
+    // Проверка на существующее имя (название удаленного трамвая свободно)
+    uint32_t id = trams_.find(name);
+    if (id != StringInterner::NOT_FOUND && routes_[id].size != 0) {
+        return "Tram '" + std::string(name) + "' already exists";
+    }
+    return checkDuplicateRoute(fingerprint, NOT_FOUND);
+}
+
+// Проверка на дубликат маршрута route_ids_ среди трамваев, кроме except:
+// сравниваем только маршруты с тем же отпечатком
+std::string TramManager::checkDuplicateRoute(uint64_t fingerprint, uint32_t except) const {
+    auto [first, last] = route_fingerprints_.equal_range(fingerprint);
+    for (auto it = first; it != last; ++it) {
+        if (it->second != except && sameRoute(it->second, route_ids_)) {
+            return "Route duplicates existing tram '" + trams_.name(it->second) + "'";
+        }
+    }
+    return "";
+}
+
+// Добавление проверенного маршрута route_ids_ в конец общего массива и индекс отпечатков;
+// трамвай с названием удаленного получает его прежний номер
+uint32_t TramManager::appendRoute(std::string_view name, uint64_t fingerprint) {
+    uint32_t tram = trams_.intern(name);
+    if (tram == routes_.size()) {
+        routes_.emplace_back();
+        route_fingerprint_.push_back(0);
+    }
+    RouteSlot& slot = routes_[tram];
+    slot.begin = static_cast<uint32_t>(route_stops_.size());
+    slot.size = slot.capacity = static_cast<uint32_t>(route_ids_.size());
+    route_stops_.insert(route_stops_.end(), route_ids_.begin(), route_ids_.end());
+    route_fingerprint_[tram] = fingerprint;
+    route_fingerprints_.emplace(fingerprint, tram);
+    ++active_trams_;
+    return tram;
+}
+
+// Удаление отпечатка трамвая из индекса
+void TramManager::eraseFingerprint(uint32_t tram) {
+    auto [first, last] = route_fingerprints_.equal_range(route_fingerprint_[tram]);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == tram) {
+            route_fingerprints_.erase(it);
+            break;
+        }
+    }
+}
+
+// Замена отпечатка трамвая в индексе
+void TramManager::setFingerprint(uint32_t tram, uint64_t fingerprint) {
+    eraseFingerprint(tram);
+    route_fingerprint_[tram] = fingerprint;
+    route_fingerprints_.emplace(fingerprint, tram);
+}
+
+// Запас под capacity остановок: маршрут в конце массива растет на месте,
+// иначе переносится в конец с двойным запасом, старый участок становится мусором.
+// Уплотнение - до переноса: оно урезает запас каждого маршрута до его длины
+// и не должно отнять только что выделенное место
+void TramManager::reserveRoute(uint32_t tram, uint32_t capacity) {
+    RouteSlot& slot = routes_[tram];
+    if (slot.capacity >= capacity) {
+        return;
+    }
+    compactRoutes();
+    if (slot.begin + slot.capacity == route_stops_.size()) {
+        route_stops_.resize(slot.begin + capacity);
+        slot.capacity = capacity;
+        return;
+    }
+    uint32_t begin = static_cast<uint32_t>(route_stops_.size());
+    route_stops_.resize(begin + 2 * capacity);
+    std::copy(route_stops_.begin() + slot.begin, route_stops_.begin() + slot.begin + slot.size,
+              route_stops_.begin() + begin);
+    route_garbage_ += slot.capacity;
+    slot.begin = begin;
+    slot.capacity = 2 * capacity;
+}
+
+// Уплотнение общего массива маршрутов, когда мусора больше половины;
+// каждая остановка переносится при уплотнении, поэтому стоимость амортизируется
+void TramManager::compactRoutes() {
+    if (route_garbage_ * 2 <= route_stops_.size()) {
+        return;
+    }
+    std::vector<uint32_t> compacted;
+    compacted.reserve(route_stops_.size() - route_garbage_);
+    for (RouteSlot& slot : routes_) {
+        uint32_t begin = static_cast<uint32_t>(compacted.size());
+        compacted.insert(compacted.end(), route_stops_.begin() + slot.begin,
+                         route_stops_.begin() + slot.begin + slot.size);
+        slot.begin = begin;
+        slot.capacity = slot.size;
+    }
+    route_stops_.swap(compacted);
+    route_garbage_ = 0;
+}
+
+// Списки трамваев на остановках остаются упорядоченными по названию
+void TramManager::insertTramAtStop(uint32_t stop, uint32_t tram) {
+    auto byName = [this](uint32_t a, uint32_t b) { return trams_.name(a) < trams_.name(b); };
+    auto& trams = stop_trams_[stop];
+    trams.insert(std::upper_bound(trams.begin(), trams.end(), tram, byName), tram);
+}
+
+void TramManager::eraseTramAtStop(uint32_t stop, uint32_t tram) {
+    auto byName = [this](uint32_t a, uint32_t b) { return trams_.name(a) < trams_.name(b); };
+    auto& trams = stop_trams_[stop];
+    auto it = std::lower_bound(trams.begin(), trams.end(), tram, byName);
+    if (it != trams.end() && *it == tram) {
+        trams.erase(it);
+    }
+}
+
+IdRange TramManager::candidateRoute() const {
+    return {route_ids_.data(), route_ids_.data() + route_ids_.size()};
+}
 
 std::string TramManager::createTram(const std::string& name, const std::vector<std::string>& stops) {
     // Проверка на минимальное количество остановок
@@ -9,59 +187,491 @@ std::string TramManager::createTram(const std::string& name, const std::vector<s
         return "ERROR: At least two stops required";
     }
     
-    // Проверка на повторяющиеся остановки
-    std::set<std::string> unique_stops(stops.begin(), stops.end());
-    if (unique_stops.size() != stops.size()) {
-        return "ERROR: Duplicate stops in route";
+    // Проверка на повторяющиеся остановки: каждая остановка помечается
+    // номером текущей проверки, повторная метка означает дубликат
+    beginRoute();
+    for (const auto& stop : stops) {
+        if (!addRouteStop(internStop(stop))) {
+            return "ERROR: Duplicate stops in route";
+        }
     }
     
-    // Проверка на существующее имя
-    if (tram_routes_.count(name)) {
-        return "ERROR: Tram '" + name + "' already exists";
+    uint64_t fingerprint = routeFingerprint(candidateRoute());
+    std::string error = checkNewRoute(name, fingerprint);
+    if (!error.empty()) {
+        return "ERROR: " + error;
     }
     
-    // Проверка на дубликат маршрута
-    for (const auto& [existing_name, existing_route] : tram_routes_) {
-        if (existing_route == stops) {
-            return "ERROR: Route duplicates existing tram '" + existing_name + "'";
-        }
+    // Добавление нового маршрута
+    uint32_t tram = appendRoute(name, fingerprint);
+    for (uint32_t stop : route_ids_) {
+        insertTramAtStop(stop, tram);
     }
+    ++version_;
     
-    // Добавление нового маршрута
-    tram_routes_[name] = stops;
-    for (const auto& stop : stops) {
-        stop_trams_[stop].insert(name);
+    return "";
+}
+
+std::string TramManager::deleteTram(const std::string& name) {
+    uint32_t tram = findTram(name);
+    if (tram == NOT_FOUND) {
+        return "ERROR: Tram '" + name + "' not found";
+    }
+    
+    for (uint32_t stop : routeStops(tram)) {
+        eraseTramAtStop(stop, tram);
     }
+    eraseFingerprint(tram);
+    route_fingerprint_[tram] = 0;
+    route_garbage_ += routes_[tram].capacity;
+    routes_[tram] = RouteSlot();
+    --active_trams_;
+    compactRoutes();
+    ++version_;
     
     return "";
 }
 
-// Остальные методы остаются без изменений
+std::string TramManager::addStop(const std::string& name, const std::string& stop, size_t position) {
+    uint32_t tram = findTram(name);
+    if (tram == NOT_FOUND) {
+        return "ERROR: Tram '" + name + "' not found";
+    }
+    IdRange route = routeStops(tram);
+    if (position < 1 || position > route.size() + 1) {
+        return "ERROR: Position out of range";
+    }
+    
+    // Новый маршрут собирается в route_ids_ и проверяется до изменения индексов
+    uint32_t id = internStop(stop);
+    route = routeStops(tram);
+    if (std::find(route.begin(), route.end(), id) != route.end()) {
+        return "ERROR: Duplicate stops in route";
+    }
+    route_ids_.assign(route.begin(), route.end());
+    route_ids_.insert(route_ids_.begin() + (position - 1), id);
+    uint64_t fingerprint = routeFingerprint(candidateRoute());
+    std::string error = checkDuplicateRoute(fingerprint, tram);
+    if (!error.empty()) {
+        return "ERROR: " + error;
+    }
+    
+    reserveRoute(tram, static_cast<uint32_t>(route_ids_.size()));
+    RouteSlot& slot = routes_[tram];
+    std::copy(route_ids_.begin(), route_ids_.end(), route_stops_.begin() + slot.begin);
+    slot.size = static_cast<uint32_t>(route_ids_.size());
+    setFingerprint(tram, fingerprint);
+    insertTramAtStop(id, tram);
+    ++version_;
+    
+    return "";
+}
+
+std::string TramManager::removeStop(const std::string& name, const std::string& stop) {
+    uint32_t tram = findTram(name);
+    if (tram == NOT_FOUND) {
+        return "ERROR: Tram '" + name + "' not found";
+    }
+    IdRange route = routeStops(tram);
+    uint32_t id = stops_.find(stop);
+    const uint32_t* pos = std::find(route.begin(), route.end(), id);
+    if (id == NOT_FOUND || pos == route.end()) {
+        return "ERROR: Stop '" + stop + "' is not in route of tram '" + name + "'";
+    }
+    if (route.size() <= 2) {
+        return "ERROR: At least two stops required";
+    }
+    
+    route_ids_.assign(route.begin(), route.end());
+    route_ids_.erase(route_ids_.begin() + (pos - route.begin()));
+    uint64_t fingerprint = routeFingerprint(candidateRoute());
+    std::string error = checkDuplicateRoute(fingerprint, tram);
+    if (!error.empty()) {
+        return "ERROR: " + error;
+    }
+    
+    RouteSlot& slot = routes_[tram];
+    std::copy(route_ids_.begin(), route_ids_.end(), route_stops_.begin() + slot.begin);
+    slot.size = static_cast<uint32_t>(route_ids_.size());
+    setFingerprint(tram, fingerprint);
+    eraseTramAtStop(id, tram);
+    ++version_;
+    
+    return "";
+}
+
+// Пакетное добавление: маршруты проверяются в порядке следования с теми же правилами,
+// что и createTram, а списки трамваев на остановках упорядочиваются один раз в конце
+void TramManager::addRoutes(const std::vector<RouteRecord>& routes, const std::vector<std::string_view>& stops,
+                            LoadReport& report) {
+    trams_.reserve(trams_.size() + routes.size());
+    route_fingerprints_.reserve(route_fingerprints_.size() + routes.size());
+    routes_.reserve(routes_.size() + routes.size());
+    route_fingerprint_.reserve(route_fingerprint_.size() + routes.size());
+    route_stops_.reserve(route_stops_.size() + stops.size());
+
+    // Все остановки пачки получают номера за один проход до проверки маршрутов
+    std::vector<uint32_t> stopIds;
+    stops_.internAll(stops, stopIds);
+    stop_trams_.resize(stops_.size());
+    stop_marks_.resize(stops_.size(), 0);
+
+    // Длина списка трамваев остановки до пачки; новые трамваи дописываются после нее
+    const uint32_t UNTOUCHED = UINT32_MAX;
+    std::vector<uint32_t> batchStart(stops_.size(), UNTOUCHED);
+    std::vector<uint32_t> touched;
+
+    auto fail = [&report](const RouteRecord& route, const std::string& message) {
+        std::string where = route.line != 0 ? "line " + std::to_string(route.line)
+                                            : "tram '" + std::string(route.name) + "'";
+        report.errors.push_back("ERROR: " + where + ": " + message);
+    };
+
+    for (const auto& route : routes) {
+        if (route.last - route.first < 2) {
+            fail(route, "At least two stops required");
+            continue;
+        }
+        beginRoute();
+        bool unique = true;
+        for (uint32_t k = route.first; k < route.last && unique; ++k) {
+            unique = addRouteStop(stopIds[k]);
+        }
+        if (!unique) {
+            fail(route, "Duplicate stops in route");
+            continue;
+        }
+        uint64_t fingerprint = routeFingerprint(candidateRoute());
+        std::string error = checkNewRoute(route.name, fingerprint);
+        if (!error.empty()) {
+            fail(route, error);
+            continue;
+        }
+        uint32_t tram = appendRoute(route.name, fingerprint);
+        for (uint32_t stop : route_ids_) {
+            if (batchStart[stop] == UNTOUCHED) {
+                batchStart[stop] = static_cast<uint32_t>(stop_trams_[stop].size());
+                touched.push_back(stop);
+            }
+            stop_trams_[stop].push_back(tram);
+        }
+        ++report.added;
+    }
+    if (touched.empty()) {
+        return;
+    }
+
+    // Новые трамваи дописаны в конец списков: сортируем хвост и сливаем с упорядоченным началом
+    auto byName = [this](uint32_t a, uint32_t b) { return trams_.name(a) < trams_.name(b); };
+    for (uint32_t stop : touched) {
+        auto& trams = stop_trams_[stop];
+        auto tail = trams.begin() + batchStart[stop];
+        std::sort(tail, trams.end(), byName);
+        std::inplace_merge(trams.begin(), tail, trams.end(), byName);
+    }
+    ++version_;
+}
+
+// Двоичный образ сети: заголовок, затем секции в порядке полей заголовка.
+// Названия хранятся как концы строк (uint64) и общий блок символов,
+// индексы - как массивы CSR из uint32 (у удаленного трамвая пустой маршрут),
+// отпечатки маршрутов - uint64
+namespace {
+
+const char NETWORK_MAGIC[8] = {'T', 'R', 'A', 'M', 'N', 'E', 'T', '1'};
+
+struct NetworkFileHeader {
+    char magic[8];
+    uint32_t tramCount;
+    uint32_t stopCount;
+    uint64_t routeStopCount;
+    uint64_t tramNameBytes;
+    uint64_t stopNameBytes;
+};
+
+// Последовательное чтение секций образа с проверкой границ
+struct ImageReader {
+    const char* pos;
+    const char* end;
+
+    const char* take(uint64_t bytes) {
+        if (bytes > static_cast<uint64_t>(end - pos)) return nullptr;
+        const char* start = pos;
+        pos += bytes;
+        return start;
+    }
+
+    template <typename T>
+    bool read(std::vector<T>& out, uint64_t count) {
+        const char* data = take(count * sizeof(T));
+        if (!data) return false;
+        out.resize(count);
+        if (count) std::memcpy(out.data(), data, count * sizeof(T));
+        return true;
+    }
+};
+
+bool writeBlock(std::FILE* file, const void* data, size_t bytes) {
+    return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+}
+
+bool writeNames(std::FILE* file, const StringInterner& names) {
+    std::vector<uint64_t> ends;
+    ends.reserve(names.size());
+    uint64_t total = 0;
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        total += names.name(id).size();
+        ends.push_back(total);
+    }
+    if (!writeBlock(file, ends.data(), ends.size() * sizeof(uint64_t))) return false;
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        if (!writeBlock(file, names.name(id).data(), names.name(id).size())) return false;
+    }
+    return true;
+}
+
+uint64_t nameBytes(const StringInterner& names) {
+    uint64_t total = 0;
+    for (uint32_t id = 0; id < names.size(); ++id) total += names.name(id).size();
+    return total;
+}
+
+// Чтение названий в пустой интернер; номера должны совпасть с порядком в образе
+bool readNames(ImageReader& reader, StringInterner& names, uint32_t count, uint64_t bytes) {
+    std::vector<uint64_t> ends;
+    if (!reader.read(ends, count)) return false;
+    const char* chars = reader.take(bytes);
+    if (!chars) return false;
+    names.reserve(count);
+    uint64_t begin = 0;
+    for (uint32_t id = 0; id < count; ++id) {
+        if (ends[id] < begin || ends[id] > bytes) return false;
+        if (names.intern(std::string_view(chars + begin, ends[id] - begin)) != id) return false;
+        begin = ends[id];
+    }
+    return true;
+}
+
+}
+
+std::string TramManager::writeBinary(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return "ERROR: Cannot open '" + path + "' for writing";
+    }
+
+    NetworkFileHeader header{};
+    std::memcpy(header.magic, NETWORK_MAGIC, sizeof(header.magic));
+    header.tramCount = static_cast<uint32_t>(trams_.size());
+    header.stopCount = static_cast<uint32_t>(stops_.size());
+    header.tramNameBytes = nameBytes(trams_);
+    header.stopNameBytes = nameBytes(stops_);
+
+    std::vector<uint32_t> routeOffsets{0};
+    routeOffsets.reserve(routes_.size() + 1);
+    for (const RouteSlot& slot : routes_) {
+        routeOffsets.push_back(routeOffsets.back() + slot.size);
+    }
+    header.routeStopCount = routeOffsets.back();
+    std::vector<uint32_t> stopOffsets{0};
+    stopOffsets.reserve(stops_.size() + 1);
+    for (const auto& trams : stop_trams_) {
+        stopOffsets.push_back(stopOffsets.back() + static_cast<uint32_t>(trams.size()));
+    }
+
+    bool ok = writeBlock(file, &header, sizeof(header))
+           && writeNames(file, trams_)
+           && writeNames(file, stops_)
+           && writeBlock(file, routeOffsets.data(), routeOffsets.size() * sizeof(uint32_t));
+    for (uint32_t tram = 0; tram < routes_.size(); ++tram) {
+        IdRange route = routeStops(tram);
+        ok = ok && writeBlock(file, route.begin(), route.size() * sizeof(uint32_t));
+    }
+    ok = ok && writeBlock(file, stopOffsets.data(), stopOffsets.size() * sizeof(uint32_t));
+    for (const auto& trams : stop_trams_) {
+        ok = ok && writeBlock(file, trams.data(), trams.size() * sizeof(uint32_t));
+    }
+    ok = ok && writeBlock(file, route_fingerprint_.data(), route_fingerprint_.size() * sizeof(uint64_t));
+    ok = (std::fclose(file) == 0) && ok;
+    return ok ? "" : "ERROR: Cannot write '" + path + "'";
+}
+
+bool TramManager::isBinaryImage(const char* data, size_t size) {
+    return size >= sizeof(NETWORK_MAGIC) && std::memcmp(data, NETWORK_MAGIC, sizeof(NETWORK_MAGIC)) == 0;
+}
+
+std::string TramManager::readBinary(const char* data, size_t size, LoadReport& report) {
+    NetworkFileHeader header;
+    ImageReader reader{data, data + size};
+    const char* head = reader.take(sizeof(header));
+    if (!head) {
+        return "ERROR: Corrupted network image";
+    }
+    std::memcpy(&header, head, sizeof(header));
+
+    // Образ читается во временный менеджер, чтобы ошибка не оставила сеть наполовину загруженной
+    TramManager image;
+    std::vector<uint32_t> routeOffsets, stopOffsets, stopTrams;
+    bool ok = readNames(reader, image.trams_, header.tramCount, header.tramNameBytes)
+           && readNames(reader, image.stops_, header.stopCount, header.stopNameBytes)
+           && reader.read(routeOffsets, uint64_t(header.tramCount) + 1)
+           && reader.read(image.route_stops_, header.routeStopCount)
+           && reader.read(stopOffsets, uint64_t(header.stopCount) + 1)
+           && reader.read(stopTrams, header.routeStopCount)
+           && reader.read(image.route_fingerprint_, header.tramCount)
+           && reader.pos == reader.end;
+
+    // Согласованность индексов: смещения монотонны, маршруты пустые или не короче
+    // двух остановок, номера в допустимых пределах
+    ok = ok && routeOffsets.front() == 0 && routeOffsets.back() == header.routeStopCount
+            && stopOffsets.front() == 0 && stopOffsets.back() == header.routeStopCount;
+    for (uint32_t tram = 0; ok && tram < header.tramCount; ++tram) {
+        ok = routeOffsets[tram] <= routeOffsets[tram + 1] && routeOffsets[tram + 1] - routeOffsets[tram] != 1;
+    }
+    for (uint32_t stop = 0; ok && stop < header.stopCount; ++stop) {
+        ok = stopOffsets[stop] <= stopOffsets[stop + 1];
+    }
+    for (size_t k = 0; ok && k < image.route_stops_.size(); ++k) {
+        ok = image.route_stops_[k] < header.stopCount;
+    }
+    if (!ok) {
+        return "ERROR: Corrupted network image";
+    }
+
+    // Маршрутам образа доверять нельзя так же, как вводу: в каждом остановки не повторяются,
+    // одинаковых маршрутов нет. Отпечатки и списки трамваев на остановках не берутся
+    // из образа, а строятся заново по маршрутам (секции остаются в формате для совместимости).
+    image.stop_marks_.assign(header.stopCount, 0);
+    image.routes_.resize(header.tramCount);
+    image.route_fingerprints_.reserve(header.tramCount);
+    std::vector<uint32_t> active;
+    for (uint32_t tram = 0; tram < header.tramCount; ++tram) {
+        RouteSlot& slot = image.routes_[tram];
+        slot.begin = routeOffsets[tram];
+        slot.size = slot.capacity = routeOffsets[tram + 1] - routeOffsets[tram];
+        image.route_fingerprint_[tram] = 0;
+        if (slot.size == 0) continue;
+
+        image.beginRoute();
+        for (uint32_t stop : image.routeStops(tram)) {
+            ok = ok && image.addRouteStop(stop);
+        }
+        uint64_t fingerprint = routeFingerprint(image.candidateRoute());
+        if (!ok || !image.checkDuplicateRoute(fingerprint, NOT_FOUND).empty()) {
+            return "ERROR: Corrupted network image";
+        }
+        image.route_fingerprint_[tram] = fingerprint;
+        image.route_fingerprints_.emplace(fingerprint, tram);
+        active.push_back(tram);
+    }
+    image.active_trams_ = active.size();
+
+    // Трамваи в порядке названий раскладываются по остановкам своих маршрутов,
+    // так что списки на остановках сразу упорядочены
+    std::sort(active.begin(), active.end(),
+              [&image](uint32_t a, uint32_t b) { return image.trams_.name(a) < image.trams_.name(b); });
+    image.stop_trams_.resize(header.stopCount);
+    for (uint32_t stop = 0; stop < header.stopCount; ++stop) {
+        image.stop_trams_[stop].reserve(stopOffsets[stop + 1] - stopOffsets[stop]);
+    }
+    for (uint32_t tram : active) {
+        for (uint32_t stop : image.routeStops(tram)) {
+            image.stop_trams_[stop].push_back(tram);
+        }
+    }
+
+    // В пустую сеть образ переносится целиком, иначе маршруты добавляются по общим правилам
+    if (trams_.size() == 0 && stops_.size() == 0) {
+        uint64_t version = version_;
+        *this = std::move(image);
+        version_ = version + 1;
+        report.added += active_trams_;
+        return "";
+    }
+    std::vector<RouteRecord> routes;
+    std::vector<std::string_view> stops;
+    routes.reserve(header.tramCount);
+    stops.reserve(header.routeStopCount);
+    for (uint32_t tram = 0; tram < header.tramCount; ++tram) {
+        if (image.routes_[tram].size == 0) continue;
+        uint32_t first = static_cast<uint32_t>(stops.size());
+        for (uint32_t stop : image.routeStops(tram)) {
+            stops.push_back(image.stops_.name(stop));
+        }
+        routes.push_back({image.trams_.name(tram), first, static_cast<uint32_t>(stops.size()), 0});
+    }
+    addRoutes(routes, stops, report);
+    return "";
+}
+
+IdRange TramManager::routeStops(uint32_t tram) const {
+    const uint32_t* begin = route_stops_.data() + routes_[tram].begin;
+    return {begin, begin + routes_[tram].size};
+}
+
+IdRange TramManager::tramsAtStop(uint32_t stop) const {
+    const auto& trams = stop_trams_[stop];
+    return {trams.data(), trams.data() + trams.size()};
+}
+
+NameView TramManager::tramsInStop(const std::string& stop) const {
+    uint32_t id = stops_.find(stop);
+    return (id != NOT_FOUND) ? NameView(trams_, tramsAtStop(id)) : NameView();
+}
+
+const std::vector<uint32_t>& TramManager::tramsByName() const {
+    if (trams_by_name_version_ != version_) {
+        trams_by_name_.clear();
+        for (uint32_t tram = 0; tram < routes_.size(); ++tram) {
+            if (routes_[tram].size != 0) {
+                trams_by_name_.push_back(tram);
+            }
+        }
+        std::sort(trams_by_name_.begin(), trams_by_name_.end(),
+                  [this](uint32_t a, uint32_t b) { return trams_.name(a) < trams_.name(b); });
+        trams_by_name_version_ = version_;
+    }
+    return trams_by_name_;
+}
+
 std::vector<std::string> TramManager::getTramsInStop(const std::string& stop) const {
-    auto it = stop_trams_.find(stop);
-    return (it != stop_trams_.end()) 
-        ? std::vector<std::string>(it->second.begin(), it->second.end())
-        : std::vector<std::string>();
+    std::vector<std::string> result;
+    uint32_t id = stops_.find(stop);
+    if (id != StringInterner::NOT_FOUND) {
+        result.reserve(stop_trams_[id].size());
+        for (uint32_t tram : stop_trams_[id]) {
+            result.push_back(trams_.name(tram));
+        }
+    }
+    return result;
 }
 
 std::vector<std::pair<std::string, std::set<std::string>>> TramManager::getStopsInTram(const std::string& tram) const {
     std::vector<std::pair<std::string, std::set<std::string>>> result;
-    auto tram_it = tram_routes_.find(tram);
+    uint32_t id = findTram(tram);
     
-    if (tram_it != tram_routes_.end()) {
-        for (const auto& stop : tram_it->second) {
+    if (id != StringInterner::NOT_FOUND) {
+        for (uint32_t stop : routeStops(id)) {
             std::set<std::string> other_trams;
-            if (auto stop_it = stop_trams_.find(stop); stop_it != stop_trams_.end()) {
-                std::copy_if(stop_it->second.begin(), stop_it->second.end(),
-                            std::inserter(other_trams, other_trams.end()),
-                            [&tram](const auto& name) { return name != tram; });
+            for (uint32_t other : stop_trams_[stop]) {
+                if (other != id) {
+                    other_trams.insert(other_trams.end(), trams_.name(other));
+                }
             }
-            result.emplace_back(stop, other_trams);
+            result.emplace_back(stops_.name(stop), std::move(other_trams));
         }
     }
     return result;
 }
 
 std::map<std::string, std::vector<std::string>> TramManager::getAllTrams() const {
-    return tram_routes_;
+    std::map<std::string, std::vector<std::string>> result;
+    for (uint32_t tram = 0; tram < routes_.size(); ++tram) {
+        if (routes_[tram].size == 0) continue;
+        auto& stops = result[trams_.name(tram)];
+        for (uint32_t stop : routeStops(tram)) {
+            stops.push_back(stops_.name(stop));
+        }
+    }
+    return result;
 }
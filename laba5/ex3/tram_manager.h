@@ -6,17 +6,197 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <cstdint>
+#include <string_view>
+#include "string_interner.h"
+
+// Непрерывный диапазон номеров во внутреннем хранилище менеджера
+struct IdRange {
+    const uint32_t* first;
+    const uint32_t* last;
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    uint32_t operator[](size_t i) const { return first[i]; }
+};
+
+// Названия по диапазону номеров без копирования строк; номер skip пропускается
+class NameView {
+public:
+    class iterator {
+    public:
+        iterator(const StringInterner* names, const uint32_t* pos, const uint32_t* end, uint32_t skip)
+            : names_(names), pos_(pos), end_(end), skip_(skip) {
+            skipExcluded();
+        }
+        const std::string& operator*() const { return names_->name(*pos_); }
+        iterator& operator++() { ++pos_; skipExcluded(); return *this; }
+        bool operator!=(const iterator& other) const { return pos_ != other.pos_; }
+        bool operator==(const iterator& other) const { return pos_ == other.pos_; }
+
+    private:
+        const StringInterner* names_;
+        const uint32_t* pos_;
+        const uint32_t* end_;
+        uint32_t skip_;
+
+        void skipExcluded() {
+            while (pos_ != end_ && *pos_ == skip_) ++pos_;
+        }
+    };
+
+    NameView() = default;
+    NameView(const StringInterner& names, IdRange ids, uint32_t skip = StringInterner::NOT_FOUND)
+        : names_(&names), ids_(ids), skip_(skip) {}
+
+    iterator begin() const { return {names_, ids_.first, ids_.last, skip_}; }
+    iterator end() const { return {names_, ids_.last, ids_.last, skip_}; }
+    bool empty() const { return !(begin() != end()); }
+
+private:
+    const StringInterner* names_ = nullptr;
+    IdRange ids_{nullptr, nullptr};
+    uint32_t skip_ = StringInterner::NOT_FOUND;
+};
+
+// Маршрут для пакетной загрузки: название и остановки ссылаются на внешний буфер,
+// остановки маршрута - stops[first..last) общего массива
+struct RouteRecord {
+    std::string_view name;
+    uint32_t first;
+    uint32_t last;
+    size_t line;      // Номер строки в файле для сообщений об ошибках; 0 - маршрут из образа, в сообщении его название
+};
+
+// Итог пакетной загрузки
+struct LoadReport {
+    size_t added = 0;
+    std::vector<std::string> errors;
+};
 
 class TramManager {
 public:
+    static constexpr uint32_t NOT_FOUND = StringInterner::NOT_FOUND;
+
     std::string createTram(const std::string& name, const std::vector<std::string>& stops);
     std::vector<std::string> getTramsInStop(const std::string& stop) const;
     std::vector<std::pair<std::string, std::set<std::string>>> getStopsInTram(const std::string& tram) const;
     std::map<std::string, std::vector<std::string>> getAllTrams() const;
 
+    // Изменение маршрутов; индексы обновляются за время, пропорциональное длине маршрута.
+    // Позиция остановки в addStop считается с 1 (size + 1 - в конец маршрута)
+    std::string deleteTram(const std::string& name);
+    std::string addStop(const std::string& tram, const std::string& stop, size_t position);
+    std::string removeStop(const std::string& tram, const std::string& stop);
+
+    // Запросы без копирования: строки и диапазоны ссылаются на внутреннее хранилище
+    // и остаются валидными до следующего изменения сети
+    NameView tramsInStop(const std::string& stop) const;
+    // visit(stop, otherTrams) для каждой остановки маршрута; false, если трамвая нет
+    template <typename Visit>
+    bool forEachStopInTram(const std::string& tram, Visit visit) const;
+    // visit(tram, stops) для всех трамваев в порядке названий
+    template <typename Visit>
+    void forEachTram(Visit visit) const;
+
+    // Пакетная загрузка и двоичный образ сети
+    void addRoutes(const std::vector<RouteRecord>& routes, const std::vector<std::string_view>& stops,
+                   LoadReport& report);
+    std::string writeBinary(const std::string& path) const;
+    std::string readBinary(const char* data, size_t size, LoadReport& report);
+    static bool isBinaryImage(const char* data, size_t size);
+
+    // Подготовка лениво вычисляемых индексов: после вызова const-методы не меняют
+    // состояние и могут одновременно вызываться из нескольких потоков
+    void freeze() const { tramsByName(); }
+
+    // Доступ к индексам по номерам для движков запросов
+    // Номера удаленных трамваев не переиспользуются другими названиями, у таких
+    // трамваев пустой маршрут; tramCount - размер пространства номеров
+    size_t stopCount() const { return stops_.size(); }
+    size_t tramCount() const { return trams_.size(); }
+    size_t activeTramCount() const { return active_trams_; }
+    uint32_t findStop(const std::string& stop) const { return stops_.find(stop); }
+    uint32_t findTram(const std::string& tram) const;
+    const std::string& stopName(uint32_t stop) const { return stops_.name(stop); }
+    const std::string& tramName(uint32_t tram) const { return trams_.name(tram); }
+    IdRange routeStops(uint32_t tram) const;
+    IdRange tramsAtStop(uint32_t stop) const;
+    // Номер версии сети, меняется при каждом изменении маршрутов
+    uint64_t version() const { return version_; }
+
 private:
-    std::map<std::string, std::vector<std::string>> tram_routes_;
-    std::map<std::string, std::set<std::string>> stop_trams_;
+    // Названия трамваев и остановок хранятся один раз, дальше используются номера
+    StringInterner trams_;
+    StringInterner stops_;
+
+    // Маршрут трамвая - участок общего массива route_stops_ с запасом под новые
+    // остановки; size == 0 - трамвай удален. Освободившиеся участки копятся
+    // в route_garbage_ и убираются уплотнением массива
+    struct RouteSlot {
+        uint32_t begin = 0;
+        uint32_t size = 0;
+        uint32_t capacity = 0;
+    };
+    std::vector<RouteSlot> routes_;
+    std::vector<uint32_t> route_stops_;
+    size_t route_garbage_ = 0;
+    size_t active_trams_ = 0;
+
+    // Для каждой остановки - номера трамваев, упорядоченные по названию трамвая
+    std::vector<std::vector<uint32_t>> stop_trams_;
+
+    // Отпечатки маршрутов по номерам остановок для быстрого поиска дубликатов
+    std::unordered_multimap<uint64_t, uint32_t> route_fingerprints_;
+    std::vector<uint64_t> route_fingerprint_;
+
+    // Рабочие буферы проверки маршрута, переиспользуются между вызовами
+    std::vector<uint32_t> route_ids_;
+    std::vector<uint32_t> stop_marks_;
+    uint32_t mark_generation_ = 0;
+    uint64_t version_ = 0;
+
+    // Трамваи, упорядоченные по названию; пересчитывается при изменении сети
+    mutable std::vector<uint32_t> trams_by_name_;
+    mutable uint64_t trams_by_name_version_ = UINT64_MAX;
+
+    uint32_t internStop(std::string_view stop);
+    void beginRoute();
+    bool addRouteStop(uint32_t id);
+    std::string checkNewRoute(std::string_view name, uint64_t fingerprint) const;
+    std::string checkDuplicateRoute(uint64_t fingerprint, uint32_t except) const;
+    uint32_t appendRoute(std::string_view name, uint64_t fingerprint);
+    void eraseFingerprint(uint32_t tram);
+    void setFingerprint(uint32_t tram, uint64_t fingerprint);
+    void reserveRoute(uint32_t tram, uint32_t capacity);
+    void compactRoutes();
+    void insertTramAtStop(uint32_t stop, uint32_t tram);
+    void eraseTramAtStop(uint32_t stop, uint32_t tram);
+    IdRange candidateRoute() const;
+    static uint64_t routeFingerprint(IdRange ids);
+    bool sameRoute(uint32_t tram, const std::vector<uint32_t>& ids) const;
+    const std::vector<uint32_t>& tramsByName() const;
 };
 
+template <typename Visit>
+bool TramManager::forEachStopInTram(const std::string& tram, Visit visit) const {
+    uint32_t id = findTram(tram);
+    if (id == NOT_FOUND) {
+        return false;
+    }
+    for (uint32_t stop : routeStops(id)) {
+        visit(stops_.name(stop), NameView(trams_, tramsAtStop(stop), id));
+    }
+    return true;
+}
+
+template <typename Visit>
+void TramManager::forEachTram(Visit visit) const {
+    for (uint32_t tram : tramsByName()) {
+        visit(trams_.name(tram), NameView(stops_, routeStops(tram)));
+    }
+}
+
 #endif
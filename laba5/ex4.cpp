@@ -1,104 +1,87 @@
 #include <iostream>
-#include <unordered_map>
-#include <string>
-#include <algorithm>
+#include <string_view>
 #include <vector>
-#include <stdexcept>
-#include <limits> // Добавляем для numeric_limits
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "region_directory.h"
 
 using namespace std;
+using namespace ex4;
 
-class RegionDirectory {
+// Весь вход одним буфером: обычный файл отображается в память (mmap),
+// канал или терминал читается до конца
+class InputText {
 private:
-    unordered_map<string, string> regions; // region -> center
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    vector<char> owned;
 
 public:
-    void change(const string& region, const string& new_center) {
-        if (regions.find(region) != regions.end()) {
-            string old_center = regions[region];
-            regions[region] = new_center;
-            cout << "Region " << region << " has changed its administrative center from " 
-                 << old_center << " to " << new_center << endl;
-        } else {
-            regions[region] = new_center;
-            cout << "New region " << region << " with administrative center " << new_center << endl;
-        }
-    }
-
-    void rename(const string& old_region, const string& new_region) {
-        if (old_region == new_region || regions.count(old_region) == 0 || regions.count(new_region) > 0) {
-            cerr << "Incorrect" << endl;
-            return;
-        }
+    InputText() = default;
+    InputText(const InputText&) = delete;
+    InputText& operator=(const InputText&) = delete;
 
-        string center = regions[old_region];
-        regions.erase(old_region);
-        regions[new_region] = center;
-        cout << old_region << " has been renamed to " << new_region << endl;
+    ~InputText() {
+        if (mapped) munmap(const_cast<char*>(mapped), mappedSize);
     }
 
-    void about(const string& region) const {
-        auto it = regions.find(region);
-        if (it != regions.end()) {
-            cout << region << " has administrative center " << it->second << endl;
-        } else {
-            cerr << "Incorrect" << endl;
+    bool load(int fd) {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            mappedSize = static_cast<size_t>(info.st_size);
+            void* address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                madvise(address, mappedSize, MADV_SEQUENTIAL);
+                mapped = static_cast<const char*>(address);
+                return true;
+            }
+            mappedSize = 0;
+        }
+        size_t size = 0;
+        owned.resize(1 << 16);
+        while (true) {
+            if (size == owned.size()) owned.resize(owned.size() * 2);
+            ssize_t n = ::read(fd, owned.data() + size, owned.size() - size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return false;
+            if (n == 0) break;
+            size += static_cast<size_t>(n);
         }
+        owned.resize(size);
+        return true;
     }
 
-    void all() const {
-        vector<pair<string, string>> sorted_regions(regions.begin(), regions.end());
-        sort(sorted_regions.begin(), sorted_regions.end());
+    bool loadFile(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        bool loaded = load(fd);
+        close(fd);
+        return loaded;
+    }
 
-        for (const auto& [region, center] : sorted_regions) {
-            cout << region << " - " << center << endl;
-        }
+    string_view text() const {
+        return mapped ? string_view(mapped, mappedSize) : string_view(owned.data(), owned.size());
     }
 };
 
-string toUpper(const string& s) {
-    string result = s;
-    transform(result.begin(), result.end(), result.begin(), ::toupper);
-    return result;
-}
-
-int main() {
-    RegionDirectory directory;
-    int N;
-    cin >> N;
-    cin.ignore();
+int main(int argc, char* argv[]) {
+    // Вход - файл из аргумента или stdin
+    InputText input;
+    if (argc > 1 ? !input.loadFile(argv[1]) : !input.load(STDIN_FILENO)) {
+        cerr << "Cannot read input" << endl;
+        return 1;
+    }
+    CommandScanner scanner(input.text());
+    Output output;
+    RegionDirectory directory(output);
+    int N = scanner.integer();
+    scanner.skipChar();
 
     for (int i = 0; i < N; ++i) {
-        string command;
-        cin >> command;
-        command = toUpper(command);
-
-        try {
-            if (command == "CHANGE") {
-                string region, center;
-                cin >> region >> center;
-                directory.change(region, center);
-            } 
-            else if (command == "RENAME") {
-                string old_region, new_region;
-                cin >> old_region >> new_region;
-                directory.rename(old_region, new_region);
-            } 
-            else if (command == "ABOUT") {
-                string region;
-                cin >> region;
-                directory.about(region);
-            } 
-            else if (command == "ALL") {
-                directory.all();
-            } 
-            else {
-                cerr << "Incorrect" << endl;
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            }
-        } catch (const exception& e) {
-            cerr << "Incorrect" << endl;
-        }
+        processCommand(scanner, directory, output);
     }
 
     return 0;
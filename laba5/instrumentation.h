@@ -0,0 +1,151 @@
+// instrumentation.h
+// Замеры команд для всех лабораторных: счетчики, гистограммы задержек и
+// таймер области видимости. Только заголовок; каждая программа заводит свой
+// объект CommandStats и выводит его отчет командой STATS. Сборка с
+// -DLAB_NO_INSTRUMENTATION превращает ScopedTimer в пустую операцию.
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace instrumentation {
+
+// Гистограмма в духе HDR: значения до 16 хранятся точно, дальше каждая степень
+// двойки делится на 16 равных корзин, так что относительная погрешность не
+// превышает 1/16 при фиксированных ~8 КБ на гистограмму
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BITS = 4;
+    static constexpr unsigned SUB_COUNT = 1u << SUB_BITS;
+    static constexpr unsigned BUCKETS = (64 - SUB_BITS + 1) * SUB_COUNT;
+
+    void record(uint64_t value) {
+        ++counts_[indexOf(value)];
+        ++total_;
+        sum_ += value;
+        if (value > max_) max_ = value;
+    }
+
+    uint64_t count() const {
+        return total_;
+    }
+
+    uint64_t max() const {
+        return max_;
+    }
+
+    double mean() const {
+        return total_ ? static_cast<double>(sum_) / total_ : 0.0;
+    }
+
+    // Верхняя граница корзины, в которую попадает доля q значений
+    uint64_t percentile(double q) const {
+        if (total_ == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(q * total_ + 0.5);
+        if (target == 0) target = 1;
+        uint64_t seen = 0;
+        for (unsigned i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                uint64_t high = highestOf(i);
+                return high < max_ ? high : max_;
+            }
+        }
+        return max_;
+    }
+
+private:
+    std::array<uint64_t, BUCKETS> counts_{};
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+
+    static unsigned indexOf(uint64_t value) {
+        if (value < SUB_COUNT) return static_cast<unsigned>(value);
+        unsigned shift = 63 - __builtin_clzll(value) - SUB_BITS;
+        return (shift + 1) * SUB_COUNT + static_cast<unsigned>((value >> shift) - SUB_COUNT);
+    }
+
+    static uint64_t highestOf(unsigned index) {
+        if (index < SUB_COUNT) return index;
+        unsigned shift = index / SUB_COUNT - 1;
+        uint64_t sub = index % SUB_COUNT;
+        return ((SUB_COUNT + sub + 1) << shift) - 1;
+    }
+};
+
+// Счетчики и гистограммы по именам команд (или этапов обработки).
+// Без блокировок: счетчики обновляет только поток, который разбирает команды,
+// а не потоки внутри движка (шарды склада, пул потоков очереди).
+class CommandStats {
+public:
+    struct Counter {
+        std::string name;
+        LatencyHistogram latency;   // Наносекунды
+    };
+
+    // Счетчик с заданным именем; создается при первом обращении.
+    // Команд немного, поэтому поиск линейный; ссылки на счетчики не меняются.
+    Counter& operator[](std::string_view name) {
+        for (Counter& counter : counters_) {
+            if (counter.name == name) return counter;
+        }
+        counters_.push_back({std::string(name), {}});
+        return counters_.back();
+    }
+
+    // Таблица: число вызовов и задержки в микросекундах
+    std::string report() const {
+        std::string text;
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %10s %10s\n",
+                      "command", "count", "mean_us", "p50_us", "p99_us", "p999_us", "max_us");
+        text += line;
+        for (const Counter& counter : counters_) {
+            const LatencyHistogram& h = counter.latency;
+            std::snprintf(line, sizeof(line), "%-16s %10llu %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+                          counter.name.c_str(), static_cast<unsigned long long>(h.count()),
+                          h.mean() / 1000, h.percentile(0.5) / 1000.0, h.percentile(0.99) / 1000.0,
+                          h.percentile(0.999) / 1000.0, h.max() / 1000.0);
+            text += line;
+        }
+        return text;
+    }
+
+private:
+    std::deque<Counter> counters_;
+};
+
+// Таймер области видимости: при выходе добавляет прошедшее время в счетчик
+class ScopedTimer {
+public:
+#ifdef LAB_NO_INSTRUMENTATION
+    explicit ScopedTimer(CommandStats::Counter&) {}
+#else
+    explicit ScopedTimer(CommandStats::Counter& counter)
+        : counter_(counter), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        counter_.latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+private:
+    CommandStats::Counter& counter_;
+    std::chrono::steady_clock::time_point start_;
+#endif
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+}
+
+#endif
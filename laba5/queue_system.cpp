@@ -0,0 +1,728 @@
+// queue_system.cpp
+#include "queue_system.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include "tokenizer.h"
+
+using namespace std;
+
+namespace ex2 {
+
+// Функция для преобразования строки в верхний регистр
+string toUpper(const string& s) {
+    string result = s;
+    transform(result.begin(), result.end(), result.begin(), ::toupper);
+    return result;
+}
+
+// Число и время выполнения команд и этапов распределения, выводятся командой STATS
+instrumentation::CommandStats commandStats;
+
+ostream& operator<<(ostream& os, TicketNumber number) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "T%03u", number.id);
+    return os << buf;
+}
+
+// Разбор номера билета из команды: "T005", "t5" или просто "5"
+bool parseTicketNumber(const string& s, uint32_t& id) {
+    size_t start = (!s.empty() && (s[0] == 'T' || s[0] == 't')) ? 1 : 0;
+    if (start == s.size() || s.size() - start > 9) return false;
+    id = 0;
+    for (size_t i = start; i < s.size(); ++i) {
+        if (!isdigit(static_cast<unsigned char>(s[i]))) return false;
+        id = id * 10 + (s[i] - '0');
+    }
+    return true;
+}
+
+// Пул потоков с перехватом задач: у каждого потока своя очередь, свободный поток
+// забирает задачи из начала чужих очередей. Вызывающий поток тоже выполняет задачи.
+class ThreadPool {
+private:
+    struct TaskQueue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<TaskQueue> queues;       // Очередь для каждого потока пула и последняя - для вызывающего
+    vector<thread> workers;
+    atomic<size_t> queued{0};       // Задачи, которые еще никто не взял
+    mutex sleepLock;
+    condition_variable wakeUp;
+    bool stopping = false;
+
+    // Выполнение одной задачи: сначала из своей очереди, затем перехват из чужих
+    bool runOne(size_t self) {
+        function<void()> task;
+        for (size_t k = 0; k < queues.size() && !task; ++k) {
+            TaskQueue& queue = queues[(self + k) % queues.size()];
+            lock_guard<mutex> guard(queue.lock);
+            if (queue.tasks.empty()) continue;
+            if (k == 0) {
+                task = move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        --queued;
+        task();
+        return true;
+    }
+
+    void workerLoop(size_t self) {
+        while (true) {
+            if (runOne(self)) continue;
+            unique_lock<mutex> guard(sleepLock);
+            wakeUp.wait(guard, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threadCount) : queues(threadCount + 1) {
+        for (size_t i = 0; i < threadCount; ++i) workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    // Количество потоков с учетом вызывающего
+    size_t size() const {
+        return queues.size();
+    }
+
+    // Выполнение body(i) для всех i из [0, count) и ожидание завершения
+    template <typename Body>
+    void parallelFor(size_t count, const Body& body) {
+        atomic<size_t> remaining{count};
+        for (size_t i = 0; i < count; ++i) {
+            TaskQueue& queue = queues[i % queues.size()];
+            ++queued;
+            lock_guard<mutex> guard(queue.lock);
+            queue.tasks.push_back([&body, &remaining, i] {
+                body(i);
+                --remaining;
+            });
+        }
+        {
+            lock_guard<mutex> guard(sleepLock);
+        }
+        wakeUp.notify_all();
+
+        while (remaining > 0) {
+            if (!runOne(queues.size() - 1)) this_thread::yield();
+        }
+    }
+};
+
+// Параллельная поразрядная сортировка билетов по убыванию времени обработки.
+// Ключ - 32 бита длительности, по 8 бит за проход; проходы, в которых у всех
+// билетов одинаковая цифра, пропускаются (для небольших длительностей их два).
+// Сортировка устойчивая: билеты с равной длительностью сохраняют порядок.
+void parallelRadixSort(vector<Ticket>& tickets, ThreadPool& pool) {
+    const size_t MIN_CHUNK = 1 << 16;   // Меньшие куски не окупают передачу в другой поток
+    size_t n = tickets.size();
+    if (n < 2) return;
+
+    // Инверсия ключа дает порядок по убыванию, сдвиг знакового бита - верный порядок для int
+    auto key = [](const Ticket& ticket) {
+        return ~(uint32_t(ticket.duration) ^ 0x80000000u);
+    };
+
+    size_t chunks = max<size_t>(1, min(pool.size() * 4, n / MIN_CHUNK));
+    size_t chunkSize = (n + chunks - 1) / chunks;
+    vector<Ticket> buffer(n);
+    vector<array<size_t, 256>> counts(chunks);
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        // Гистограмма цифр в каждом куске
+        pool.parallelFor(chunks, [&](size_t chunk) {
+            counts[chunk].fill(0);
+            size_t end = min(n, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) ++counts[chunk][(key(tickets[i]) >> shift) & 255];
+        });
+
+        // Начальные позиции для каждой пары (цифра, кусок)
+        size_t offset = 0;
+        bool trivial = false;
+        for (int digit = 0; digit < 256 && !trivial; ++digit) {
+            size_t digitTotal = 0;
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                size_t count = counts[chunk][digit];
+                counts[chunk][digit] = offset;
+                offset += count;
+                digitTotal += count;
+            }
+            trivial = digitTotal == n;
+        }
+        if (trivial) continue;
+
+        // Раскладка: каждый кусок пишет в свои позиции, поэтому без синхронизации
+        pool.parallelFor(chunks, [&](size_t chunk) {
+            array<size_t, 256>& position = counts[chunk];
+            size_t end = min(n, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; ++i) {
+                buffer[position[(key(tickets[i]) >> shift) & 255]++] = tickets[i];
+            }
+        });
+        tickets.swap(buffer);
+    }
+}
+
+// Запись номера билета в строку без потоков ввода-вывода
+void appendTicketNumber(string& out, uint32_t id) {
+    char buf[16];
+    int length = snprintf(buf, sizeof(buf), "T%03u", id);
+    out.append(buf, length);
+}
+
+// Жадная стратегия LPT: очередной билет отдается наименее загруженному окну.
+// Работает за O(n log W), но может отличаться от оптимума до 4/3 раза.
+class LptScheduler : public Scheduler {
+public:
+    Schedule assign(const vector<Ticket>& tickets, int windowsCount) const override {
+        Schedule schedule{vector<int>(tickets.size()), vector<long long>(windowsCount, 0)};
+
+        // Используем минимальную кучу для отслеживания загрузки окон
+        // Храним пары (суммарное время обработки, индекс окна)
+        priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> minHeap;
+
+        // Инициализируем все окна с нулевой загрузкой
+        for (int i = 0; i < windowsCount; ++i) {
+            minHeap.push({0, i});
+        }
+
+        // Распределяем билеты по окнам
+        for (size_t i = 0; i < tickets.size(); ++i) {
+            // Берем окно с минимальной текущей загрузкой
+            auto [currentTime, windowIdx] = minHeap.top();
+            minHeap.pop();
+
+            // Добавляем билет в это окно
+            schedule.windowOf[i] = windowIdx;
+            // Возвращаем окно обратно в кучу с обновленным временем
+            minHeap.push({currentTime + tickets[i].duration, windowIdx});
+        }
+
+        // Итоговая загрузка окон берется прямо из кучи
+        while (!minHeap.empty()) {
+            schedule.loads[minHeap.top().second] = minHeap.top().first;
+            minHeap.pop();
+        }
+        return schedule;
+    }
+};
+
+// Метод разностей Кармаркара-Карпа для двух окон.
+// Два самых больших значения заменяются их разностью: это решение положить
+// соответствующие группы билетов в разные окна. В конце решения раскрываются в обратном порядке.
+class KarmarkarKarpScheduler : public Scheduler {
+public:
+    bool supports(int windowsCount) const override {
+        return windowsCount == 2;
+    }
+
+    Schedule assign(const vector<Ticket>& tickets, int) const override {
+        size_t n = tickets.size();
+        Schedule schedule{vector<int>(n, 0), vector<long long>(2, 0)};
+        if (n == 0) return schedule;
+        vector<int>& windowOf = schedule.windowOf;
+
+        // Куча пар (разность, индекс билета, представляющего группу)
+        priority_queue<pair<long long, size_t>> heap;
+        long long total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            heap.push({tickets[i].duration, i});
+            total += tickets[i].duration;
+        }
+
+        // merges[k] = (a, b): группа b попадает в окно, противоположное группе a
+        vector<pair<size_t, size_t>> merges;
+        merges.reserve(n - 1);
+        while (heap.size() > 1) {
+            auto [largest, a] = heap.top();
+            heap.pop();
+            auto [second, b] = heap.top();
+            heap.pop();
+            merges.push_back({a, b});
+            heap.push({largest - second, a});
+        }
+
+        // Корень остается в окне 0, остальные решения раскрываются с конца
+        for (size_t k = merges.size(); k-- > 0;) {
+            windowOf[merges[k].second] = 1 - windowOf[merges[k].first];
+        }
+
+        // Оставшееся в куче значение - разность загрузок окна 0 и окна 1
+        long long difference = heap.top().first;
+        schedule.loads[0] = (total + difference) / 2;
+        schedule.loads[1] = (total - difference) / 2;
+        return schedule;
+    }
+};
+
+// Дерево отрезков по остаткам вместимости окон: поиск первого окна,
+// в которое помещается билет, за O(log W)
+class FirstFitTree {
+private:
+    int size;
+    vector<long long> best;   // максимальный остаток в поддереве
+
+public:
+    FirstFitTree(int windowsCount, long long capacity) : size(1) {
+        while (size < windowsCount) size *= 2;
+        best.assign(2 * size, -1);
+        for (int i = 0; i < windowsCount; ++i) best[size + i] = capacity;
+        for (int i = size - 1; i > 0; --i) best[i] = max(best[2 * i], best[2 * i + 1]);
+    }
+
+    // Номер первого окна с остатком не меньше need или -1
+    int firstFit(long long need) const {
+        if (best[1] < need) return -1;
+        int node = 1;
+        while (node < size) {
+            node = best[2 * node] >= need ? 2 * node : 2 * node + 1;
+        }
+        return node - size;
+    }
+
+    void take(int window, long long amount) {
+        int node = size + window;
+        best[node] -= amount;
+        for (node /= 2; node > 0; node /= 2) best[node] = max(best[2 * node], best[2 * node + 1]);
+    }
+};
+
+// MULTIFIT: двоичный поиск минимальной вместимости окна, при которой
+// билеты раскладываются алгоритмом First Fit Decreasing
+class MultifitScheduler : public Scheduler {
+private:
+    static const int ITERATIONS = 12;   // число шагов двоичного поиска
+
+    // Раскладка FFD с вместимостью capacity; false, если билеты не поместились
+    static bool firstFitDecreasing(const vector<Ticket>& tickets, int windowsCount,
+                                   long long capacity, Schedule& schedule) {
+        FirstFitTree tree(windowsCount, capacity);
+        schedule.loads.assign(windowsCount, 0);
+        for (size_t i = 0; i < tickets.size(); ++i) {
+            int window = tree.firstFit(tickets[i].duration);
+            if (window < 0) return false;
+            tree.take(window, tickets[i].duration);
+            schedule.windowOf[i] = window;
+            schedule.loads[window] += tickets[i].duration;
+        }
+        return true;
+    }
+
+public:
+    Schedule assign(const vector<Ticket>& tickets, int windowsCount) const override {
+        long long total = 0, longest = 0;
+        for (const auto& ticket : tickets) {
+            total += ticket.duration;
+            longest = max<long long>(longest, ticket.duration);
+        }
+
+        // Классические границы MULTIFIT: при верхней границе FFD всегда успешен
+        long long lower = max((total + windowsCount - 1) / windowsCount, longest);
+        long long upper = max((2 * total + windowsCount - 1) / windowsCount, longest);
+
+        Schedule best{vector<int>(tickets.size()), {}};
+        Schedule candidate{vector<int>(tickets.size()), {}};
+        firstFitDecreasing(tickets, windowsCount, upper, best);
+        for (int step = 0; step < ITERATIONS && lower < upper; ++step) {
+            long long capacity = lower + (upper - lower) / 2;
+            if (firstFitDecreasing(tickets, windowsCount, capacity, candidate)) {
+                upper = capacity;
+                swap(best, candidate);
+            } else {
+                lower = capacity + 1;
+            }
+        }
+        return best;
+    }
+};
+
+// Точный метод ветвей и границ для небольших входов. Начинает с лучшего из
+// решений LPT и MULTIFIT и перебирает раскладки, отсекая ветви, которые не лучше
+// найденного решения. По истечении бюджета времени возвращает лучшее найденное решение.
+class BranchAndBoundScheduler : public Scheduler {
+private:
+    // Больше билетов перебор не успевает даже дойти до первого листа за бюджет,
+    // поэтому для них возвращается начальное решение без перебора
+    static const size_t MAX_SEARCH_TICKETS = 100000;
+    // Объем работы (сравнений загрузок окон) между проверками времени
+    static const long long WORK_PER_CLOCK_CHECK = 4096;
+
+    chrono::milliseconds budget;
+
+    struct Search {
+        const vector<Ticket>& tickets;
+        vector<long long> loads;          // текущая загрузка окон
+        vector<int> current;              // текущая раскладка
+        Schedule best;                    // лучшая найденная раскладка
+        long long bestMakespan;
+        long long lowerBound;             // нижняя граница: решение с ней заведомо оптимально
+        chrono::steady_clock::time_point deadline;
+        long long work = 0;               // работа с последней проверки времени
+        bool timedOut = false;
+
+        Search(const vector<Ticket>& t, int windowsCount) : tickets(t), loads(windowsCount, 0),
+            current(t.size()) {}
+
+        bool stopped() const {
+            return timedOut || bestMakespan == lowerBound;
+        }
+
+        // Вход в узел на глубине index; false, если его дети не перебираются.
+        // Время проверяется на каждом узле, но часы читаются только после того,
+        // как накопится WORK_PER_CLOCK_CHECK сравнений, - узел стоит O(W^2)
+        bool enter(size_t index, long long makespan) {
+            if (stopped()) return false;
+            work += (long long)loads.size() * loads.size();
+            if (work >= WORK_PER_CLOCK_CHECK) {
+                work = 0;
+                if (chrono::steady_clock::now() > deadline) {
+                    timedOut = true;
+                    return false;
+                }
+            }
+            if (index == tickets.size()) {
+                if (makespan < bestMakespan) {
+                    bestMakespan = makespan;
+                    best.windowOf = current;
+                    best.loads = loads;
+                }
+                return false;
+            }
+            return makespan < bestMakespan;
+        }
+
+        // Следующее окно для билета index, начиная с from; loads.size(), если окон нет
+        size_t nextWindow(size_t index, size_t from) const {
+            int duration = tickets[index].duration;
+            for (size_t w = from; w < loads.size(); ++w) {
+                // Окна с одинаковой загрузкой взаимозаменяемы: пробуем только первое
+                bool seen = false;
+                for (size_t prev = 0; prev < w && !seen; ++prev) seen = loads[prev] == loads[w];
+                if (!seen && loads[w] + duration < bestMakespan) return w;
+            }
+            return loads.size();
+        }
+
+        // Перебор в глубину с явным стеком: глубина равна числу билетов,
+        // и рекурсия переполняла бы стек на больших входах
+        void run() {
+            size_t n = tickets.size();
+            vector<size_t> tried(n + 1, 0);        // следующее окно для перебора на глубине
+            vector<long long> makespans(n + 1, 0); // наибольшая загрузка окна в узле
+            size_t index = 0;
+            bool open = enter(0, 0);
+            while (true) {
+                if (open) {
+                    size_t w = nextWindow(index, tried[index]);
+                    if (w < loads.size()) {
+                        tried[index] = w + 1;
+                        loads[w] += tickets[index].duration;
+                        current[index] = w;
+                        makespans[index + 1] = max(makespans[index], loads[w]);
+                        ++index;
+                        tried[index] = 0;
+                        open = enter(index, makespans[index]);
+                        continue;
+                    }
+                }
+                // Дети узла перебраны или отсечены: возврат к родителю
+                if (index == 0) break;
+                --index;
+                loads[current[index]] -= tickets[index].duration;
+                open = !stopped();
+            }
+        }
+    };
+
+public:
+    explicit BranchAndBoundScheduler(chrono::milliseconds timeBudget) : budget(timeBudget) {}
+
+    Schedule assign(const vector<Ticket>& tickets, int windowsCount) const override {
+        Search search(tickets, windowsCount);
+
+        // Начальное решение - лучшее из LPT и MULTIFIT
+        search.best = LptScheduler().assign(tickets, windowsCount);
+        search.bestMakespan = *max_element(search.best.loads.begin(), search.best.loads.end());
+        Schedule multifit = MultifitScheduler().assign(tickets, windowsCount);
+        long long multifitMakespan = *max_element(multifit.loads.begin(), multifit.loads.end());
+        if (multifitMakespan < search.bestMakespan) {
+            search.best = move(multifit);
+            search.bestMakespan = multifitMakespan;
+        }
+        if (tickets.size() > MAX_SEARCH_TICKETS) return search.best;
+
+        long long total = 0;
+        for (const auto& ticket : tickets) total += ticket.duration;
+        long long longest = tickets.empty() ? 0 : tickets.front().duration;
+        search.lowerBound = max((total + windowsCount - 1) / windowsCount, longest);
+        search.deadline = chrono::steady_clock::now() + budget;
+
+        search.run();
+        return search.best;
+    }
+};
+
+// Создание стратегии по имени из команды DISTRIBUTE; nullptr для неизвестного имени
+unique_ptr<Scheduler> makeScheduler(const string& name) {
+    string upperName = toUpper(name);
+    if (upperName.empty() || upperName == "LPT") return make_unique<LptScheduler>();
+    if (upperName == "KK") return make_unique<KarmarkarKarpScheduler>();
+    if (upperName == "MULTIFIT") return make_unique<MultifitScheduler>();
+    if (upperName == "BNB") return make_unique<BranchAndBoundScheduler>(chrono::milliseconds(1000));
+    return nullptr;
+}
+
+void IndexedMinHeap::siftUp(int i) {
+    while (i > 0 && less(heap[i], heap[(i - 1) / 2])) {
+        swapNodes(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+void IndexedMinHeap::siftDown(int i) {
+    int n = heap.size();
+    while (true) {
+        int smallest = i;
+        for (int child = 2 * i + 1; child <= 2 * i + 2 && child < n; ++child) {
+            if (less(heap[child], heap[smallest])) smallest = child;
+        }
+        if (smallest == i) return;
+        swapNodes(i, smallest);
+        i = smallest;
+    }
+}
+
+void QueueSystem::enqueue(int duration) {
+    Ticket ticket;
+    ticket.id = generateTicketNumber();    // Генерируем номер
+    ticket.duration = duration;            // Устанавливаем длительность
+
+    if (online) {
+        // Отдаем билет наименее загруженному окну и обновляем его загрузку
+        int window = windowLoads.top();
+        windowLoads.add(window, duration);
+        pending.emplace_back(window, duration);
+        ++pendingCount[window];
+        out << ">>> " << TicketNumber{ticket.id} << " -> Окно " << (window + 1) << '\n';
+        return;
+    }
+
+    tickets.push_back(ticket);              // Добавляем в общий список
+    out << ">>> " << TicketNumber{ticket.id} << '\n'; // Выводим номер билета
+}
+
+void QueueSystem::complete(int window, const string& number) {
+    uint32_t id;
+    bool known = parseTicketNumber(number, id) && id >= firstPending && id - firstPending < pending.size();
+    if (window < 1 || window > windowsCount || !known || pending[id - firstPending].first != window - 1) {
+        out << ">>> Ошибка: билет " << number << " не ожидает в окне " << window << '\n';
+        return;
+    }
+
+    // Уменьшаем загрузку окна на время обслуженного билета
+    auto [windowIdx, duration] = pending[id - firstPending];
+    windowLoads.add(windowIdx, -duration);
+    --pendingCount[windowIdx];
+    ++doneCount[windowIdx];
+    pending[id - firstPending].first = -1;
+    while (pendingHead < pending.size() && pending[pendingHead].first < 0) ++pendingHead;
+    if (pendingHead * 2 >= pending.size()) {
+        pending.erase(pending.begin(), pending.begin() + pendingHead);
+        firstPending += pendingHead;
+        pendingHead = 0;
+    }
+    out << ">>> Билет " << TicketNumber{id} << " обслужен в окне " << window << '\n';
+}
+
+void QueueSystem::printStats() const {
+    long long maxTime = 0;
+    for (int i = 0; i < windowsCount; ++i) {
+        out << ">>> Окно " << (i + 1) << ": в очереди " << pendingCount[i]
+             << " (" << windowLoads.load(i) << " минут), обслужено " << doneCount[i] << '\n';
+        maxTime = max(maxTime, windowLoads.load(i));
+    }
+    out << ">>> Максимальное время обработки: " << maxTime << " минут" << '\n';
+}
+
+void QueueSystem::distribute(const Scheduler& scheduler, unsigned threads) {
+    // Пул потоков по числу ядер (вызывающий поток тоже участвует)
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    ThreadPool pool(threads - 1);
+
+    // Сортируем билеты по убыванию времени обработки
+    {
+        instrumentation::ScopedTimer timer(commandStats["sort"]);
+        parallelRadixSort(tickets, pool);
+    }
+    
+    // Получаем номер окна для каждого билета и загрузку окон
+    Schedule schedule;
+    {
+        instrumentation::ScopedTimer timer(commandStats["assign"]);
+        schedule = scheduler.assign(tickets, windowsCount);
+    }
+    const vector<int>& windowOf = schedule.windowOf;
+    const vector<long long>& windowTimes = schedule.loads;
+
+    // Раскладываем билеты по окнам сортировкой подсчетом в один плоский массив:
+    // билеты окна i занимают windowTickets[windowStart[i] .. windowStart[i + 1])
+    vector<size_t> windowStart(windowsCount + 1, 0);
+    for (size_t i = 0; i < tickets.size(); ++i) {
+        ++windowStart[windowOf[i] + 1];
+    }
+    for (int i = 0; i < windowsCount; ++i) windowStart[i + 1] += windowStart[i];
+    vector<uint32_t> windowTickets(tickets.size());
+    vector<size_t> next(windowStart.begin(), windowStart.end() - 1);
+    for (size_t i = 0; i < tickets.size(); ++i) {
+        windowTickets[next[windowOf[i]]++] = tickets[i].id;
+    }
+    
+    // Строки окон формируются параллельно, каждая в своем буфере
+    vector<string> lines(windowsCount);
+    pool.parallelFor(windowsCount, [&](size_t i) {
+        if (windowStart[i] == windowStart[i + 1]) return;
+        string& line = lines[i];
+        line.reserve((windowStart[i + 1] - windowStart[i]) * 6 + 48);
+        line += ">>> Окно " + to_string(i + 1) + " (" + to_string(windowTimes[i]) + " минут): ";
+        // Выводим все билеты для этого окна
+        for (size_t k = windowStart[i]; k < windowStart[i + 1]; ++k) {
+            if (k != windowStart[i]) line += ", ";
+            appendTicketNumber(line, windowTickets[k]);
+        }
+        line += '\n';
+    });
+
+    // Выводим результаты распределения одной записью
+    string output;
+    size_t outputSize = 0;
+    for (const string& line : lines) outputSize += line.size();
+    output.reserve(outputSize);
+    for (const string& line : lines) output += line;
+    out.write(output.data(), output.size());
+    
+    // Находим и выводим максимальное время обработки среди всех окон
+    long long maxTime = *max_element(windowTimes.begin(), windowTimes.end());
+    out << ">>> Максимальное время обработки: " << maxTime << " минут" << '\n';
+}
+
+enum class QueueCommand { ENQUEUE, DONE, STATS, DISTRIBUTE, UNKNOWN };
+
+// Имена команд для счетчиков STATS, в порядке QueueCommand
+const string_view queueCommandNames[] = {"ENQUEUE", "DONE", "STATS", "DISTRIBUTE", "UNKNOWN"};
+
+// Команды без учета регистра; совершенный хеш подбирается при компиляции
+constexpr auto queueCommands = tokenizer::makeKeywordTable<QueueCommand>({
+    {"ENQUEUE", QueueCommand::ENQUEUE},
+    {"DONE", QueueCommand::DONE},
+    {"STATS", QueueCommand::STATS},
+    {"DISTRIBUTE", QueueCommand::DISTRIBUTE},
+}, QueueCommand::UNKNOWN);
+
+// Выполнение одной команды из in с выводом ответа в out.
+// Возвращает false, когда работа закончена: ввод исчерпан или билеты распределены.
+bool processCommand(istream& in, QueueSystem& system, ostream& out) {
+    string command;
+    if (!(in >> command)) {
+        if (in.eof()) return false; // Ввод закончился
+        in.clear();
+        in.ignore(numeric_limits<streamsize>::max(), '\n');
+        return true;
+    }
+    
+    // Команда распознается без учета регистра
+    QueueCommand kind = queueCommands.find(command);
+
+    // Время каждой команды попадает в счетчик с ее именем, неизвестные - в общий
+    instrumentation::ScopedTimer timer(commandStats[queueCommandNames[static_cast<size_t>(kind)]]);
+    
+    if (kind == QueueCommand::ENQUEUE) {
+        int duration;
+        if (in >> duration) {
+            // Добавляем новый билет с указанной длительностью
+            system.enqueue(duration);
+        } else {
+            out << ">>> Ошибка: введите число для длительности" << '\n';
+            in.clear();
+            in.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+    } 
+    else if (system.isOnline() && kind == QueueCommand::DONE) {
+        int window;
+        string number;
+        if (in >> window >> number) {
+            // Окно обслужило билет
+            system.complete(window, number);
+        } else {
+            out << ">>> Ошибка: используйте DONE <окно> <билет>" << '\n';
+            in.clear();
+            in.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+    }
+    else if (kind == QueueCommand::STATS) {
+        // Состояние окон (онлайн-режим) и таблица времени выполнения команд
+        if (system.isOnline()) system.printStats();
+        out << commandStats.report();
+    }
+    else if (!system.isOnline() && kind == QueueCommand::DISTRIBUTE) {
+        // Необязательное имя стратегии до конца строки (по умолчанию LPT)
+        string rest, strategy;
+        getline(in, rest);
+        istringstream(rest) >> strategy;
+
+        unique_ptr<Scheduler> scheduler = makeScheduler(strategy);
+        if (!scheduler) {
+            out << ">>> Неизвестная стратегия. Используйте LPT, KK, MULTIFIT или BNB." << '\n';
+            return true;
+        }
+        if (!scheduler->supports(system.getWindowsCount())) {
+            out << ">>> Стратегия " << toUpper(strategy) << " не поддерживает "
+            << system.getWindowsCount() << " окон" << '\n';
+            return true;
+        }
+
+        // Распределяем билеты по окнам и выводим результат
+        system.distribute(*scheduler);
+        return false; // Завершаем работу после распределения
+    } 
+    else if (system.isOnline()) {
+        out << ">>> Неизвестная команда. Используйте ENQUEUE, DONE или STATS." << '\n';
+        in.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    else {
+        out << ">>> Неизвестная команда. Используйте ENQUEUE, DISTRIBUTE или STATS." << '\n';
+        in.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,169 @@
+// queue_system.h
+// Электронная очередь (лабораторная 2): билеты, стратегии распределения по окнам
+// и обработка команд. Используется программой ex2 и сервером (server/).
+#ifndef QUEUE_SYSTEM_H
+#define QUEUE_SYSTEM_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "instrumentation.h"
+
+namespace ex2 {
+
+// Число и время выполнения команд и этапов распределения, выводятся командой STATS
+extern instrumentation::CommandStats commandStats;
+
+// Структура, представляющая билет. Простая запись без строк: номер хранится
+// числом и превращается в текст вида "T123" только при выводе
+struct Ticket {
+    uint32_t id;      // Уникальный номер билета (выдаются по порядку с 1)
+    int duration;     // Время обработки билета в минутах
+    
+    // Оператор для сравнения билетов по времени обработки (для сортировки)
+    bool operator>(const Ticket& other) const {
+        return duration > other.duration;
+    }
+};
+
+// Номер билета для вывода в потоке: T001, T002, ..., T1000, ...
+struct TicketNumber {
+    uint32_t id;
+};
+
+std::ostream& operator<<(std::ostream& os, TicketNumber number);
+
+
+// Базовый класс стратегии распределения билетов по окнам.
+// Все стратегии получают билеты, отсортированные по убыванию времени обработки,
+// и возвращают номер окна для каждого билета вместе с итоговой загрузкой окон.
+struct Schedule {
+    std::vector<int> windowOf;       // Номер окна для каждого билета
+    std::vector<long long> loads;    // Суммарное время обработки каждого окна
+};
+
+class Scheduler {
+public:
+    virtual ~Scheduler() = default;
+
+    // Поддерживает ли стратегия заданное количество окон
+    virtual bool supports(int windowsCount) const {
+        return windowsCount > 0;
+    }
+
+    virtual Schedule assign(const std::vector<Ticket>& tickets, int windowsCount) const = 0;
+};
+
+// Создание стратегии по имени из команды DISTRIBUTE; nullptr для неизвестного имени
+std::unique_ptr<Scheduler> makeScheduler(const std::string& name);
+
+// Индексированная минимальная куча загрузок окон: в отличие от priority_queue
+// позволяет изменить загрузку любого окна за O(log W)
+class IndexedMinHeap {
+private:
+    std::vector<int> heap;           // номера окон в порядке кучи
+    std::vector<int> position;       // окно -> позиция в heap
+    std::vector<long long> loads;    // окно -> суммарное время обработки
+
+    // Окна с равной загрузкой упорядочиваются по номеру, чтобы выбор был детерминированным
+    bool less(int a, int b) const {
+        return loads[a] != loads[b] ? loads[a] < loads[b] : a < b;
+    }
+
+    void swapNodes(int i, int j) {
+        std::swap(heap[i], heap[j]);
+        position[heap[i]] = i;
+        position[heap[j]] = j;
+    }
+
+    void siftUp(int i);
+
+    void siftDown(int i);
+
+public:
+    explicit IndexedMinHeap(int windowsCount) : heap(windowsCount), position(windowsCount), loads(windowsCount, 0) {
+        // Все окна с нулевой загрузкой - куча уже упорядочена
+        for (int i = 0; i < windowsCount; ++i) heap[i] = position[i] = i;
+    }
+
+    // Наименее загруженное окно
+    int top() const {
+        return heap[0];
+    }
+
+    long long load(int window) const {
+        return loads[window];
+    }
+
+    // Изменение загрузки окна на delta минут
+    void add(int window, long long delta) {
+        loads[window] += delta;
+        if (delta < 0) siftUp(position[window]);
+        else siftDown(position[window]);
+    }
+};
+
+// Класс системы управления очередями
+class QueueSystem {
+private:
+    int windowsCount;               // Количество окон обслуживания
+    std::vector<Ticket> tickets;    // Все билеты в системе (непрерывный массив простых записей)
+    uint32_t ticketCounter = 1;     // Счетчик для генерации номеров билетов
+
+    // Онлайн-режим: билет назначается окну сразу при постановке в очередь
+    bool online;                                                // Включен ли онлайн-режим
+    IndexedMinHeap windowLoads;                                 // Текущая загрузка окон (необслуженные билеты)
+    // Билеты онлайн-режима подряд по номерам, начиная с firstPending: (окно, длительность),
+    // окно -1 - билет уже обслужен. Обслуженное начало массива отрезается, когда
+    // занимает не меньше половины, поэтому поиск и удаление - O(1) амортизированно.
+    std::vector<std::pair<int, int>> pending;
+    uint32_t firstPending = 1;                                  // Номер билета в pending[0]
+    size_t pendingHead = 0;                                     // Первый необслуженный билет в pending
+    std::vector<int> pendingCount;                              // Количество ожидающих билетов в каждом окне
+    std::vector<int> doneCount;                                 // Количество обслуженных билетов в каждом окне
+    std::ostream& out;                                          // Куда выводятся ответы
+
+    // Генерация номера билета: номера выдаются по порядку и никогда не повторяются
+    uint32_t generateTicketNumber() {
+        return ticketCounter++;
+    }
+
+public:
+    // Конструктор, инициализирующий количество окон
+    QueueSystem(int numWindows, bool onlineMode = false, std::ostream& output = std::cout)
+        : windowsCount(numWindows), online(onlineMode), windowLoads(numWindows),
+          pendingCount(numWindows, 0), doneCount(numWindows, 0), out(output) {
+    }
+
+    int getWindowsCount() const {
+        return windowsCount;
+    }
+
+    bool isOnline() const {
+        return online;
+    }
+
+    // Добавление нового билета в систему
+    void enqueue(int duration);
+
+    // Окно сообщает об обслуживании билета (онлайн-режим)
+    void complete(int window, const std::string& number);
+
+    // Текущее состояние окон (онлайн-режим), не завершает работу
+    void printStats() const;
+
+    // Распределение билетов по окнам выбранной стратегией; threads - число потоков
+    // для сортировки и вывода (0 - по числу ядер)
+    void distribute(const Scheduler& scheduler, unsigned threads = 0);
+};
+
+// Выполнение одной команды из in с выводом ответа в out.
+// Возвращает false, когда работа закончена: ввод исчерпан или билеты распределены.
+bool processCommand(std::istream& in, QueueSystem& system, std::ostream& out);
+
+}
+
+#endif
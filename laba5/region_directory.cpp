@@ -0,0 +1,359 @@
+// region_directory.cpp
+#include "region_directory.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace ex4 {
+
+// Число и время выполнения команд, выводятся командой STATS
+instrumentation::CommandStats commandStats;
+
+// Ключевые слова без учета регистра; совершенный хеш подбирается при компиляции
+constexpr auto commandKeywords = tokenizer::makeKeywordTable<Command>({
+    {"CHANGE", Command::CHANGE},
+    {"RENAME", Command::RENAME},
+    {"ABOUT", Command::ABOUT},
+    {"ALL", Command::ALL},
+    {"HISTORY", Command::HISTORY},
+    {"STATS", Command::STATS},
+}, Command::UNKNOWN);
+
+string_view StringArena::store(string_view text) {
+    if (text.size() > left || !current) {
+        size_t size = max(BLOCK_SIZE, text.size());
+        blocks.emplace_back(new char[size]);
+        current = blocks.back().get();
+        left = size;
+    }
+    if (!text.empty()) memcpy(current, text.data(), text.size());
+    string_view stored(current, text.size());
+    current += text.size();
+    left -= text.size();
+    return stored;
+}
+
+OutputBuffer& OutputBuffer::operator<<(uint32_t value) {
+    char digits[10];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n) data.push_back(digits[--n]);
+    return *this;
+}
+
+void OutputBuffer::flush() {
+    if (fd < 0) return;
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    data.clear();
+}
+
+
+Output::Output() {
+    struct stat out, err;
+    sharedTarget = fstat(STDOUT_FILENO, &out) == 0 && fstat(STDERR_FILENO, &err) == 0 &&
+                   out.st_dev == err.st_dev && out.st_ino == err.st_ino;
+}
+
+int CommandScanner::integer() {
+    string_view digits = token();
+    long long value = 0;
+    bool negative = !digits.empty() && (digits[0] == '-' || digits[0] == '+');
+    size_t i = negative ? 1 : 0;
+    negative = negative && digits[0] == '-';
+    size_t first = i;
+    while (i < digits.size() && digits[i] >= '0' && digits[i] <= '9') {
+        value = min<long long>(value * 10 + (digits[i] - '0'), 1LL << 31);
+        ++i;
+    }
+    if (i == first) return 0;
+    position -= digits.size() - i;     // Нецифровой хвост читается как следующий токен
+    if (negative) return static_cast<int>(max(-value, -(1LL << 31)));
+    return static_cast<int>(min<long long>(value, (1LL << 31) - 1));
+}
+
+uint32_t RegionTable::matchByte(const int8_t* group, int8_t value) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP; ++i) {
+        if (group[i] == value) mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+size_t RegionTable::probe(string_view key, size_t hash, size_t& insertAt) const {
+    int8_t h2 = shortHash(hash);
+    insertAt = SIZE_MAX;
+    size_t group = (hash >> 7) & groupMask;
+    for (size_t step = 1;; ++step) {
+        const int8_t* ctrl = control.data() + group * GROUP;
+        for (uint32_t mask = matchByte(ctrl, h2); mask; mask &= mask - 1) {
+            size_t index = group * GROUP + lowestBit(mask);
+            if (slots[index].region == key) return index;
+        }
+        // Группа с пустой ячейкой завершает цепочку: дальше ключ положен быть не мог
+        if (uint32_t empty = matchByte(ctrl, EMPTY)) {
+            insertAt = group * GROUP + lowestBit(empty);
+            return SIZE_MAX;
+        }
+        group = (group + step) & groupMask;   // Треугольные числа обходят все группы
+    }
+}
+
+void RegionTable::rehash(size_t groups) {
+    vector<int8_t> oldControl(groups * GROUP, EMPTY);
+    vector<Slot> oldSlots(groups * GROUP);
+    oldControl.swap(control);
+    oldSlots.swap(slots);
+    groupMask = groups - 1;
+    for (size_t i = 0; i < oldSlots.size(); ++i) {
+        if (oldControl[i] < 0) continue;
+        size_t hash = hashKey(oldSlots[i].region), insertAt;
+        probe(oldSlots[i].region, hash, insertAt);
+        control[insertAt] = shortHash(hash);
+        slots[insertAt] = oldSlots[i];
+    }
+}
+
+pair<RegionTable::Slot*, bool> RegionTable::findOrInsert(string_view key) {
+    size_t hash = hashKey(key), insertAt;
+    size_t index = probe(key, hash, insertAt);
+    if (index != SIZE_MAX) return {&slots[index], false};
+    control[insertAt] = shortHash(hash);
+    ++used;
+    return {&slots[insertAt], true};
+}
+
+void RegionIndex::merge() {
+    vector<Entry> merged;
+    merged.reserve(run.size() - deadInRun + delta.size());
+    size_t d = 0;
+    for (const Entry& e : run) {
+        if (!e.live) continue;
+        while (d < delta.size() && delta[d] < e.key) merged.push_back({delta[d++], true});
+        merged.push_back(e);
+    }
+    while (d < delta.size()) merged.push_back({delta[d++], true});
+    run.swap(merged);
+    delta.clear();
+    deadInRun = 0;
+}
+
+void RegionIndex::insert(string_view key) {
+    auto it = findInRun(key);
+    if (it != run.end()) {
+        // Ключ удалялся раньше - просто оживляем запись
+        it->live = true;
+        --deadInRun;
+        return;
+    }
+    delta.insert(lower_bound(delta.begin(), delta.end(), key), key);
+    maybeMerge();
+}
+
+void RegionIndex::erase(string_view key) {
+    auto it = findInRun(key);
+    if (it != run.end()) {
+        it->live = false;
+        ++deadInRun;
+    } else {
+        auto pos = lower_bound(delta.begin(), delta.end(), key);
+        if (pos != delta.end() && *pos == key) delta.erase(pos);
+    }
+    maybeMerge();
+}
+
+void RegionDirectory::record(RegionTable::Slot& slot, string_view center, string_view renamedFrom) {
+    if (slot.history == RegionTable::NO_HISTORY) {
+        slot.history = static_cast<uint32_t>(histories.size());
+        histories.emplace_back();
+    }
+    vector<Revision>& history = histories[slot.history];
+    uint32_t index = static_cast<uint32_t>(history.size());
+    bool continues = !history.empty() && history.back().center.data() && renamedFrom.empty();
+    history.push_back({version, continues ? history.back().birth : index, center, renamedFrom});
+}
+
+const RegionDirectory::Revision* RegionDirectory::revisionAt(const RegionTable::Slot& slot, uint32_t at) const {
+    if (slot.history == RegionTable::NO_HISTORY) return nullptr;
+    const vector<Revision>& history = histories[slot.history];
+    auto it = upper_bound(history.begin(), history.end(), at,
+                          [](uint32_t v, const Revision& r) { return v < r.version; });
+    return it == history.begin() ? nullptr : &*(it - 1);
+}
+
+void RegionDirectory::change(string_view region, string_view new_center) {
+    regions.reserveOne();
+    auto [slot, inserted] = regions.findOrInsert(region);
+    if (slot->live()) {
+        output.out() << "Region " << region << " has changed its administrative center from "
+                     << slot->center << " to " << new_center << '\n';
+        slot->center = arena.store(new_center);
+    } else {
+        if (inserted) slot->region = arena.store(region);
+        slot->center = arena.store(new_center);
+        order.insert(slot->region);
+        output.out() << "New region " << region << " with administrative center " << new_center << '\n';
+    }
+    record(*slot, slot->center);
+}
+
+void RegionDirectory::rename(string_view old_region, string_view new_region) {
+    regions.reserveOne();
+    RegionTable::Slot* from = (old_region == new_region) ? nullptr : regions.find(old_region);
+    if (!from || !from->live()) {
+        output.err() << "Incorrect" << '\n';
+        return;
+    }
+    auto [to, inserted] = regions.findOrInsert(new_region);
+    if (to->live()) {
+        output.err() << "Incorrect" << '\n';
+        return;
+    }
+
+    if (inserted) to->region = arena.store(new_region);
+    to->center = from->center;
+    from->center = {};
+    order.erase(from->region);
+    order.insert(to->region);
+    record(*from, {});
+    record(*to, to->center, from->region);
+    output.out() << old_region << " has been renamed to " << new_region << '\n';
+}
+
+void RegionDirectory::about(string_view region) const {
+    const RegionTable::Slot* slot = regions.find(region);
+    if (slot && slot->live()) {
+        output.out() << region << " has administrative center " << slot->center << '\n';
+    } else {
+        output.err() << "Incorrect" << '\n';
+    }
+}
+
+void RegionDirectory::about(string_view region, uint32_t at) const {
+    const RegionTable::Slot* slot = regions.find(region);
+    const Revision* revision = (slot && at <= version) ? revisionAt(*slot, at) : nullptr;
+    if (revision && revision->center.data()) {
+        output.out() << region << " had administrative center " << revision->center
+                     << " at version " << at << '\n';
+    } else {
+        output.err() << "Incorrect" << '\n';
+    }
+}
+
+void RegionDirectory::history(string_view region) const {
+    const RegionTable::Slot* slot = regions.find(region);
+    if (!slot || !slot->live()) {
+        output.err() << "Incorrect" << '\n';
+        return;
+    }
+    string_view name = region;
+    uint32_t at = version;
+    bool renamed = false;
+    while (true) {
+        const Revision* revision = revisionAt(*slot, at);
+        const Revision& birth = histories[slot->history][revision->birth];
+        if (birth.renamedFrom.empty()) break;
+        output.out() << name << " was renamed from " << birth.renamedFrom
+                     << " at version " << birth.version << '\n';
+        renamed = true;
+        name = birth.renamedFrom;
+        at = birth.version - 1;
+        slot = regions.find(name);
+    }
+    if (!renamed) {
+        output.out() << region << " has never been renamed" << '\n';
+    }
+}
+
+// Разбор "@N" в номер версии
+bool parseVersion(string_view token, uint32_t& at) {
+    if (token.size() < 2 || token[0] != '@' || token.size() > 11) return false;
+    uint64_t value = 0;
+    for (size_t i = 1; i < token.size(); ++i) {
+        if (!isdigit(static_cast<unsigned char>(token[i]))) return false;
+        value = value * 10 + static_cast<uint64_t>(token[i] - '0');
+    }
+    if (value > UINT32_MAX) return false;
+    at = static_cast<uint32_t>(value);
+    return true;
+}
+
+// Выполнение одной команды: аргументы читаются из scanner, ответы пишутся в output
+void processCommand(CommandScanner& scanner, RegionDirectory& directory, Output& output) {
+    string_view command = scanner.token();
+    directory.nextCommand();
+    Command kind = commandKeywords.find(command);
+    instrumentation::ScopedTimer timer(commandStats[commandNames[static_cast<size_t>(kind)]]);
+
+    try {
+        switch (kind) {
+        case Command::CHANGE: {
+            string_view region = scanner.token();
+            string_view center = scanner.token();
+            directory.change(region, center);
+            break;
+        }
+        case Command::RENAME: {
+            string_view old_region = scanner.token();
+            string_view new_region = scanner.token();
+            directory.rename(old_region, new_region);
+            break;
+        }
+        case Command::ABOUT: {
+            // Необязательная версия "@N" - остаток строки
+            string_view region = scanner.token();
+            string_view at = scanner.tokenInRestOfLine();
+            uint32_t version;
+            if (at.empty()) {
+                directory.about(region);
+            } else if (parseVersion(at, version)) {
+                directory.about(region, version);
+            } else {
+                output.err() << "Incorrect" << '\n';
+            }
+            break;
+        }
+        case Command::HISTORY:
+            directory.history(scanner.token());
+            break;
+        case Command::ALL:
+            // Необязательный префикс - остаток строки
+            directory.all(scanner.tokenInRestOfLine());
+            break;
+        case Command::STATS:
+            output.out() << string_view(commandStats.report());
+            break;
+        case Command::UNKNOWN:
+            output.err() << "Incorrect" << '\n';
+            scanner.restOfLine();
+            break;
+        }
+    } catch (const exception& e) {
+        output.err() << "Incorrect" << '\n';
+    }
+}
+
+}
@@ -0,0 +1,339 @@
+// region_directory.h
+// Справочник регионов (лабораторная 4): хеш-таблица и упорядоченный индекс
+// названий, история ревизий и обработка команд. Используется программой ex4
+// и сервером (server/).
+#ifndef REGION_DIRECTORY_H
+#define REGION_DIRECTORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "instrumentation.h"
+#include "tokenizer.h"
+
+namespace ex4 {
+
+// Арена строк: символы дописываются в большие блоки и освобождаются только
+// вместе с ареной, поэтому string_view на них остаются действительными
+class StringArena {
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 20;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* current = nullptr;
+    size_t left = 0;
+
+public:
+    std::string_view store(std::string_view text);
+};
+
+// Буфер вывода в один файловый дескриптор; сбрасывается целиком вызовом write.
+// При fd < 0 данные только копятся в памяти и забираются через take().
+class OutputBuffer {
+private:
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+    int fd;
+    std::string data;
+
+public:
+    explicit OutputBuffer(int fd) : fd(fd) {
+        data.reserve(FLUSH_SIZE + 4096);
+    }
+
+    OutputBuffer& operator<<(std::string_view text) {
+        data.append(text.data(), text.size());
+        return *this;
+    }
+
+    OutputBuffer& operator<<(char c) {
+        data.push_back(c);
+        if (c == '\n' && fd >= 0 && data.size() >= FLUSH_SIZE) flush();
+        return *this;
+    }
+
+    OutputBuffer& operator<<(uint32_t value);
+
+    bool empty() const {
+        return data.empty();
+    }
+
+    void take(std::string& to) {
+        to += data;
+        data.clear();
+    }
+
+    void flush();
+};
+
+// Раздельные буферы stdout и stderr. Если оба потока ведут в один файл или
+// терминал, при смене потока сбрасывается другой буфер, так что сообщения
+// выходят в исходном порядке; иначе каждый буфер копится независимо.
+// В режиме захвата (для сервера) оба потока пишутся в один буфер в памяти.
+class Output {
+private:
+    OutputBuffer buffers[2] = {OutputBuffer(STDOUT_FILENO), OutputBuffer(STDERR_FILENO)};
+    bool sharedTarget = false;
+    bool captured = false;
+
+    OutputBuffer& select(int index) {
+        if (captured) return buffers[0];
+        if (sharedTarget && !buffers[1 - index].empty()) buffers[1 - index].flush();
+        return buffers[index];
+    }
+
+public:
+    struct Capture {};
+
+    explicit Output(Capture) : buffers{OutputBuffer(-1), OutputBuffer(-1)}, captured(true) {}
+
+    Output();
+
+    ~Output() {
+        flush();
+    }
+
+    OutputBuffer& out() {
+        return select(0);
+    }
+
+    OutputBuffer& err() {
+        return select(1);
+    }
+
+    void flush() {
+        buffers[0].flush();
+        buffers[1].flush();
+    }
+
+    // Накопленный в режиме захвата вывод
+    void take(std::string& to) {
+        buffers[0].take(to);
+    }
+};
+
+// Разбор входа без копирования (tokenizer.h): токены - string_view на буфер входа.
+// Повторяет поведение cin >> / getline, в том числе пустой токен в конце входа.
+class CommandScanner : public tokenizer::Tokenizer {
+public:
+    using Tokenizer::Tokenizer;
+
+    // Число как у cin >> int: при ошибке 0
+    int integer();
+};
+
+enum class Command { CHANGE, RENAME, ABOUT, ALL, HISTORY, STATS, UNKNOWN };
+
+// Имена команд для счетчиков STATS, в порядке Command
+const std::string_view commandNames[] = {"CHANGE", "RENAME", "ABOUT", "ALL", "HISTORY", "STATS", "UNKNOWN"};
+
+// Число и время выполнения команд, выводятся командой STATS
+extern instrumentation::CommandStats commandStats;
+
+// Хеш-таблица с открытой адресацией в стиле Swiss table. Ячейки разбиты на
+// группы по 16; для каждой ячейки хранится управляющий байт: EMPTY или
+// младшие 7 бит хеша ключа. Поиск проверяет сразу всю группу (SSE2)
+// и сравнивает ключи только в ячейках с совпавшими 7 битами.
+// Имена из таблицы не удаляются: за каждым закреплена история ревизий,
+// а переименованный регион лишь помечается отсутствующим.
+class RegionTable {
+public:
+    static constexpr uint32_t NO_HISTORY = UINT32_MAX;
+
+    struct Slot {
+        std::string_view region;
+        std::string_view center;          // data() == nullptr - региона сейчас нет
+        uint32_t history = NO_HISTORY;    // Номер истории ревизий имени
+
+        bool live() const {
+            return center.data() != nullptr;
+        }
+    };
+
+private:
+    static constexpr size_t GROUP = 16;
+    static constexpr int8_t EMPTY = -128;
+
+    std::vector<int8_t> control;
+    std::vector<Slot> slots;
+    size_t groupMask = 0;
+    size_t used = 0;        // Занятые ячейки
+
+    static size_t hashKey(std::string_view key) {
+        return std::hash<std::string_view>{}(key);
+    }
+
+    static int8_t shortHash(size_t hash) {
+        return static_cast<int8_t>(hash & 0x7f);
+    }
+
+    // Битовая маска ячеек группы с управляющим байтом value
+    static uint32_t matchByte(const int8_t* group, int8_t value);
+
+    static unsigned lowestBit(uint32_t mask) {
+        return static_cast<unsigned>(__builtin_ctz(mask));
+    }
+
+    // Поиск ячейки ключа; при отсутствии ключа insertAt - пустая ячейка для него
+    size_t probe(std::string_view key, size_t hash, size_t& insertAt) const;
+
+    void rehash(size_t groups);
+
+public:
+    RegionTable() {
+        rehash(1);
+    }
+
+    size_t size() const {
+        return used;
+    }
+
+    // Запас под одну вставку, чтобы указатели на ячейки не менялись во время команды
+    void reserveOne() {
+        if ((used + 1) * 8 <= control.size() * 7) return;
+        rehash(control.size() / GROUP * 2);
+    }
+
+    Slot* find(std::string_view key) {
+        size_t insertAt;
+        size_t index = probe(key, hashKey(key), insertAt);
+        return index == SIZE_MAX ? nullptr : &slots[index];
+    }
+
+    const Slot* find(std::string_view key) const {
+        return const_cast<RegionTable*>(this)->find(key);
+    }
+
+    // Ячейка ключа и признак, что она только что занята (тогда ключ нужно записать);
+    // перед вызовом нужен reserveOne()
+    std::pair<Slot*, bool> findOrInsert(std::string_view key);
+};
+
+// Упорядоченный индекс названий регионов: большой отсортированный массив и
+// небольшой отсортированный буфер новых ключей, который сливается в массив,
+// когда вырастает до ~sqrt(n). Удалённые из массива ключи только помечаются,
+// а массив уплотняется, как только помеченных становится больше того же порога,
+// поэтому обход их не больше ~sqrt(n) даже при сплошных удалениях.
+// Обход с префиксом - два lower_bound и слияние двух диапазонов: O(log n + k).
+class RegionIndex {
+private:
+    struct Entry {
+        std::string_view key;
+        bool live;
+    };
+
+    static constexpr size_t MIN_DELTA = 64;
+
+    std::vector<Entry> run;                // Отсортирован, может содержать удалённые ключи
+    std::vector<std::string_view> delta;   // Отсортирован, ключей из run в нём нет
+    size_t deadInRun = 0;
+
+    std::vector<Entry>::iterator findInRun(std::string_view key) {
+        auto it = std::lower_bound(run.begin(), run.end(), key,
+                              [](const Entry& e, std::string_view k) { return e.key < k; });
+        return (it != run.end() && it->key == key) ? it : run.end();
+    }
+
+    void merge();
+
+    void maybeMerge() {
+        size_t limit = MIN_DELTA;
+        while (limit * limit < run.size()) limit *= 2;
+        if (delta.size() > limit || deadInRun > limit) merge();
+    }
+
+public:
+    // Ключ должен жить не меньше индекса (строки хранятся в арене)
+    void insert(std::string_view key);
+
+    void erase(std::string_view key);
+
+    // Обход ключей с заданным префиксом по возрастанию
+    template <typename Visit>
+    void forEachWithPrefix(std::string_view prefix, Visit visit) const {
+        auto r = std::lower_bound(run.begin(), run.end(), prefix,
+                             [](const Entry& e, std::string_view k) { return e.key < k; });
+        auto d = std::lower_bound(delta.begin(), delta.end(), prefix);
+        auto matches = [prefix](std::string_view key) {
+            return key.substr(0, prefix.size()) == prefix;
+        };
+        while (true) {
+            while (r != run.end() && !r->live) ++r;
+            bool runOk = r != run.end() && matches(r->key);
+            bool deltaOk = d != delta.end() && matches(*d);
+            if (!runOk && !deltaOk) break;
+            if (runOk && (!deltaOk || r->key < *d)) {
+                visit(r->key);
+                ++r;
+            } else {
+                visit(*d);
+                ++d;
+            }
+        }
+    }
+};
+
+class RegionDirectory {
+private:
+    // Ревизия имени: состояние региона с этим именем начиная с версии version.
+    // Версия - номер выполненной команды, версия 0 - пустой справочник.
+    struct Revision {
+        uint32_t version;
+        uint32_t birth;                  // Первая ревизия текущего существования имени
+        std::string_view center;         // data() == nullptr - региона с таким именем нет
+        std::string_view renamedFrom;    // Прежнее имя, если регион появился переименованием
+    };
+
+    Output& output;
+    RegionTable regions; // region -> center
+    RegionIndex order;   // Названия регионов по алфавиту
+    StringArena arena;
+    std::vector<std::vector<Revision>> histories;
+    uint32_t version = 0;
+
+    void record(RegionTable::Slot& slot, std::string_view center, std::string_view renamedFrom = {});
+
+    // Ревизия, действовавшая в версии at, или nullptr, если имя тогда не использовалось
+    const Revision* revisionAt(const RegionTable::Slot& slot, uint32_t at) const;
+
+public:
+    explicit RegionDirectory(Output& output) : output(output) {}
+
+    // Каждая команда, в том числе ошибочная, получает следующий номер версии
+    void nextCommand() {
+        ++version;
+    }
+
+    void change(std::string_view region, std::string_view new_center);
+
+    void rename(std::string_view old_region, std::string_view new_region);
+
+    void about(std::string_view region) const;
+
+    // Центр региона с именем region после выполнения команды номер at
+    void about(std::string_view region, uint32_t at) const;
+
+    // Цепочка прежних имён региона, от последнего переименования к первому
+    void history(std::string_view region) const;
+
+    // Все регионы (или только начинающиеся с prefix) в алфавитном порядке
+    void all(std::string_view prefix = {}) const {
+        order.forEachWithPrefix(prefix, [this](std::string_view region) {
+            output.out() << region << " - " << regions.find(region)->center << '\n';
+        });
+    }
+};
+
+// Выполнение одной команды: аргументы читаются из scanner, ответы пишутся в output
+void processCommand(CommandScanner& scanner, RegionDirectory& directory, Output& output);
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+// engine.h
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Движок одной из лабораторных, выполняющий команды построчно. Каждый движок
+// обслуживается ровно одним рабочим потоком сервера, поэтому его состояние
+// не требует синхронизации.
+class Engine {
+public:
+    virtual ~Engine() = default;
+
+    virtual const char* name() const = 0;
+
+    // Выполнение одной строки-запроса; весь вывод команды (и ответы, и ошибки)
+    // дописывается в response
+    virtual void execute(std::string_view line, std::string& response) = 0;
+
+    // Вызывается после пачки запросов до отправки ответов на них
+    virtual void commit() {}
+};
+
+struct EngineOptions {
+    std::string warehouseData;  // Каталог хранения склада (--data); пусто - без хранения
+    int queueWindows = 3;       // Количество окон очереди (--windows)
+    std::string tramData;       // Каталог файлов LOAD/DUMP трамвайной сети (--tram-data); пусто - команды отключены
+};
+
+std::unique_ptr<Engine> makeWarehouseEngine(const EngineOptions& options);
+std::unique_ptr<Engine> makeQueueEngine(const EngineOptions& options);
+std::unique_ptr<Engine> makeTramEngine(const EngineOptions& options);
+std::unique_ptr<Engine> makeRegionEngine(const EngineOptions& options);
+
+#endif
@@ -0,0 +1,209 @@
+// Нагрузочный клиент для lab_server: несколько соединений с одним движком,
+// в каждом до <pipeline> запросов в полете. Выводит пропускную способность
+// и задержки (p50/p99/p99.9/max) от отправки запроса до получения ответа.
+//
+//     lab_load <сокет> <warehouse|queue|trams|regions>
+//              [--connections C] [--requests R] [--pipeline D] [--seed S]
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+namespace {
+
+// Генераторы запросов: смесь изменяющих и читающих команд каждого движка
+string warehouseRequest(mt19937_64& random) {
+    static const char zones[] = {'A', 'B', 'C'};
+    string address = string(1, zones[random() % 3]) + to_string(1 + random() % 20) +
+                     to_string(1 + random() % 5) + to_string(1 + random() % 2);
+    string item = "item" + to_string(random() % 200);
+    switch (random() % 5) {
+        case 0:
+        case 1:
+        case 2: return "ADD " + item + " " + to_string(1 + random() % 10) + " " + address;
+        case 3: return "REMOVE " + item + " 1 " + address;
+        default: return "FIND " + item;
+    }
+}
+
+string queueRequest(mt19937_64& random) {
+    switch (random() % 10) {
+        case 0: return "STATS";
+        case 1:
+        case 2: return "DONE " + to_string(1 + random() % 3) + " T" + to_string(1 + random() % 1000);
+        default: return "ENQUEUE " + to_string(1 + random() % 60);
+    }
+}
+
+// Изменения сети редки: после каждого планировщик перестраивает граф пересадок
+string tramRequest(mt19937_64& random) {
+    auto stop = [&random] { return "S" + to_string(random() % 300); };
+    if (random() % 50 == 0) {
+        string request = "CREATE_TRAM T" + to_string(random() % 2000);
+        for (int i = 0; i < 6; ++i) request += " " + stop();
+        return request;
+    }
+    return random() % 2 ? "TRAMS_IN_STOP " + stop() : "ROUTE " + stop() + " " + stop();
+}
+
+string regionRequest(mt19937_64& random) {
+    string region = "R" + to_string(random() % 100000);
+    switch (random() % 10) {
+        case 0: return "RENAME " + region + " R" + to_string(random() % 100000);
+        case 1:
+        case 2:
+        case 3:
+        case 4: return "CHANGE " + region + " C" + to_string(random() % 1000);
+        default: return "ABOUT " + region;
+    }
+}
+
+struct Options {
+    string socket;
+    function<string(mt19937_64&)> generate;
+    size_t connections = 4;
+    size_t requests = 100000;   // На соединение
+    size_t pipeline = 16;
+    uint64_t seed = 1;
+};
+
+bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Одно соединение: держит до pipeline запросов в полете и записывает задержку каждого
+bool runConnection(const Options& options, size_t index, vector<uint32_t>& latencies) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, options.socket.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        cerr << "Cannot connect to " << options.socket << ": " << strerror(errno) << "\n";
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    mt19937_64 random(options.seed * 1000003 + index);
+    deque<Clock::time_point> inFlight;
+    size_t issued = 0;
+    string input;
+    size_t parsed = 0;
+    char buffer[1 << 16];
+    latencies.reserve(options.requests);
+
+    while (latencies.size() < options.requests) {
+        // Дозаполняем конвейер одной записью
+        string batch;
+        Clock::time_point now = Clock::now();
+        while (issued < options.requests && inFlight.size() < options.pipeline) {
+            batch += options.generate(random);
+            batch += '\n';
+            inFlight.push_back(now);
+            ++issued;
+        }
+        if (!batch.empty() && !sendAll(fd, batch)) break;
+
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        input.append(buffer, static_cast<size_t>(n));
+
+        // Кадр ответа: "<длина>\n<вывод>"
+        Clock::time_point received = Clock::now();
+        while (true) {
+            size_t newline = input.find('\n', parsed);
+            if (newline == string::npos) break;
+            size_t length = strtoull(input.c_str() + parsed, nullptr, 10);
+            if (input.size() - newline - 1 < length) break;
+            parsed = newline + 1 + length;
+            auto latency = chrono::duration_cast<chrono::nanoseconds>(received - inFlight.front()).count();
+            latencies.push_back(static_cast<uint32_t>(min<long long>(latency, UINT32_MAX)));
+            inFlight.pop_front();
+        }
+        input.erase(0, parsed);
+        parsed = 0;
+    }
+    close(fd);
+    return latencies.size() == options.requests;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <socket> <warehouse|queue|trams|regions>"
+             << " [--connections C] [--requests R] [--pipeline D] [--seed S]\n";
+        return 1;
+    }
+    Options options;
+    options.socket = argv[1];
+    string_view engine = argv[2];
+    if (engine == "warehouse") options.generate = warehouseRequest;
+    else if (engine == "queue") options.generate = queueRequest;
+    else if (engine == "trams") options.generate = tramRequest;
+    else if (engine == "regions") options.generate = regionRequest;
+    else {
+        cerr << "Unknown engine " << engine << "\n";
+        return 1;
+    }
+    for (int i = 3; i + 1 < argc; i += 2) {
+        string_view arg = argv[i];
+        size_t value = strtoull(argv[i + 1], nullptr, 10);
+        if (arg == "--connections") options.connections = max<size_t>(1, value);
+        else if (arg == "--requests") options.requests = max<size_t>(1, value);
+        else if (arg == "--pipeline") options.pipeline = max<size_t>(1, value);
+        else if (arg == "--seed") options.seed = value;
+    }
+
+    vector<vector<uint32_t>> latencies(options.connections);
+    vector<char> ok(options.connections, 0);
+    Clock::time_point start = Clock::now();
+    {
+        vector<thread> threads;
+        for (size_t i = 0; i < options.connections; ++i) {
+            threads.emplace_back([&, i] { ok[i] = runConnection(options, i, latencies[i]); });
+        }
+        for (thread& t : threads) t.join();
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<uint32_t> all;
+    for (const auto& part : latencies) all.insert(all.end(), part.begin(), part.end());
+    if (all.empty()) {
+        cerr << "No responses received\n";
+        return 1;
+    }
+    sort(all.begin(), all.end());
+    auto percentile = [&all](double p) {
+        return all[min(all.size() - 1, static_cast<size_t>(p * all.size()))] / 1000.0;
+    };
+    cout << engine << ": " << all.size() << " requests over " << options.connections
+         << " connection(s), pipeline " << options.pipeline << "\n"
+         << "throughput: " << static_cast<uint64_t>(all.size() / seconds) << " req/s\n"
+         << "latency us: p50 " << percentile(0.5) << ", p99 " << percentile(0.99)
+         << ", p99.9 " << percentile(0.999) << ", max " << all.back() / 1000.0 << "\n";
+    return count(ok.begin(), ok.end(), 1) == static_cast<long>(ok.size()) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "../queue_system.h"
+#include "engine.h"
+
+using namespace std;
+
+namespace {
+
+// Сервер работает с очередью в онлайн-режиме: ENQUEUE, DONE и STATS.
+// Пакетное распределение (DISTRIBUTE) завершает работу ex2 и здесь недоступно.
+class QueueEngine : public Engine {
+private:
+    ostringstream output;
+    ex2::QueueSystem system;
+
+public:
+    explicit QueueEngine(const EngineOptions& options)
+        : system(options.queueWindows, true, output) {}
+
+    const char* name() const override {
+        return "queue";
+    }
+
+    void execute(string_view line, string& response) override {
+        istringstream in{string(line)};
+        while (ex2::processCommand(in, system, output)) {
+        }
+        response += output.str();
+        output.str("");
+    }
+};
+
+}
+
+unique_ptr<Engine> makeQueueEngine(const EngineOptions& options) {
+    return make_unique<QueueEngine>(options);
+}
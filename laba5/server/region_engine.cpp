@@ -0,0 +1,33 @@
+#include <memory>
+#include <string>
+#include <string_view>
+#include "../region_directory.h"
+#include "engine.h"
+
+using namespace std;
+
+namespace {
+
+// В отличие от ex4 количество команд не передается: каждая строка - одна команда
+class RegionEngine : public Engine {
+private:
+    ex4::Output output{ex4::Output::Capture{}};
+    ex4::RegionDirectory directory{output};
+
+public:
+    const char* name() const override {
+        return "regions";
+    }
+
+    void execute(string_view line, string& response) override {
+        ex4::CommandScanner scanner(line);
+        ex4::processCommand(scanner, directory, output);
+        output.take(response);
+    }
+};
+
+}
+
+unique_ptr<Engine> makeRegionEngine(const EngineOptions&) {
+    return make_unique<RegionEngine>();
+}
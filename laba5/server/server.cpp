@@ -0,0 +1,452 @@
+// Единый сервер для всех четырех лабораторных: склад (ex1), очередь (ex2),
+// трамваи (ex3) и регионы (ex4). Каждый движок слушает свой Unix-сокет
+// <каталог>/<движок>.sock. Протокол строчный: клиент шлет команды по одной на
+// строку, не дожидаясь ответов (конвейер); на каждую строку сервер отвечает
+// кадром "<длина вывода>\n<вывод>" в том же порядке.
+//
+// Сетевой ввод-вывод - один неблокирующий цикл epoll. Все полные строки,
+// прочитанные из соединения за раз, уходят рабочему потоку движка одной
+// задачей; ответы на всю пачку возвращаются вместе и пишутся одним write.
+// Каждый движок закреплен за одним рабочим потоком, а поток - за ядром,
+// поэтому состояние движка не делится между потоками и не требует блокировок.
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "engine.h"
+
+using namespace std;
+
+namespace {
+
+const size_t READ_CHUNK = 1 << 16;
+const size_t MAX_PENDING_INPUT = 16 << 20;   // Строка длиннее - соединение закрывается
+const size_t OUTPUT_HIGH_WATER = 16 << 20;   // Выше - соединение перестает читаться
+
+// Пачка строк одного соединения и ответы на нее
+struct Job {
+    uint64_t connection;
+    size_t engine;
+    string lines;       // Полные строки, разделенные '\n'
+    string responses;   // Кадры ответов, заполняет рабочий поток
+};
+
+// Завершенные задачи возвращаются в цикл epoll через eventfd
+class CompletionQueue {
+private:
+    mutex lock;
+    vector<Job> done;
+    int eventFd;
+
+public:
+    explicit CompletionQueue(int eventFd) : eventFd(eventFd) {}
+
+    void push(Job&& job) {
+        {
+            lock_guard<mutex> guard(lock);
+            done.push_back(move(job));
+        }
+        uint64_t one = 1;
+        ssize_t written = write(eventFd, &one, sizeof(one));
+        (void)written;   // Переполнение счетчика eventfd невозможно на практике
+    }
+
+    void take(vector<Job>& jobs) {
+        lock_guard<mutex> guard(lock);
+        jobs.swap(done);
+    }
+};
+
+// Рабочий поток: выполняет задачи движков, закрепленных за ним, по порядку
+class Worker {
+private:
+    mutex lock;
+    condition_variable ready;
+    deque<Job> jobs;
+    bool stopping = false;
+    vector<unique_ptr<Engine>>& engines;
+    CompletionQueue& completions;
+    thread worker;
+
+    static void appendFrame(string& responses, const string& output) {
+        responses += to_string(output.size());
+        responses += '\n';
+        responses += output;
+    }
+
+    void run() {
+        string output;
+        while (true) {
+            Job job;
+            {
+                unique_lock<mutex> guard(lock);
+                ready.wait(guard, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = move(jobs.front());
+                jobs.pop_front();
+            }
+
+            Engine& engine = *engines[job.engine];
+            string_view lines = job.lines;
+            size_t start = 0;
+            while (start < lines.size()) {
+                size_t end = lines.find('\n', start);
+                if (end == string_view::npos) end = lines.size();
+                output.clear();
+                engine.execute(lines.substr(start, end - start), output);
+                appendFrame(job.responses, output);
+                start = end + 1;
+            }
+            engine.commit();
+            job.lines.clear();
+            completions.push(move(job));
+        }
+    }
+
+public:
+    Worker(vector<unique_ptr<Engine>>& engines, CompletionQueue& completions, int cpu)
+        : engines(engines), completions(completions), worker([this] { run(); }) {
+        // Закрепление за ядром: данные движков остаются в кэше одного ядра
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(worker.native_handle(), sizeof(set), &set);
+    }
+
+    ~Worker() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_one();
+        worker.join();
+    }
+
+    void submit(Job&& job) {
+        {
+            lock_guard<mutex> guard(lock);
+            jobs.push_back(move(job));
+        }
+        ready.notify_one();
+    }
+};
+
+struct Connection {
+    int fd;
+    size_t engine;
+    string input;           // Непрочитанный остаток (неполная строка)
+    string output;          // Ответы, ожидающие отправки
+    size_t sent = 0;        // Сколько байт output уже отправлено
+    size_t inFlight = 0;    // Задачи соединения в рабочих потоках
+    bool peerClosed = false;
+    uint32_t events = 0;    // Текущая подписка epoll
+};
+
+// Метки событий epoll: слушающие сокеты - номер движка, служебные дескрипторы -
+// особые значения, соединения - их идентификатор (начиная с FIRST_CONNECTION)
+const uint64_t EVENT_TAG = 100;
+const uint64_t SIGNAL_TAG = 101;
+const uint64_t FIRST_CONNECTION = 1000;
+
+class Server {
+private:
+    int epollFd;
+    int eventFd;
+    int signalFd;
+    vector<int> listeners;
+    vector<string> socketPaths;
+    vector<unique_ptr<Engine>> engines;
+    CompletionQueue completions;
+    vector<unique_ptr<Worker>> workers;
+    vector<size_t> workerOf;                         // Движок -> рабочий поток
+    unordered_map<uint64_t, Connection> connections;
+    uint64_t nextConnection = FIRST_CONNECTION;
+    bool running = true;
+
+    void subscribe(uint64_t id, Connection& connection) {
+        uint32_t events = 0;
+        if (!connection.peerClosed && connection.output.size() - connection.sent < OUTPUT_HIGH_WATER) {
+            events |= EPOLLIN;
+        }
+        if (connection.sent < connection.output.size()) events |= EPOLLOUT;
+        if (events == connection.events) return;
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+
+    void close(uint64_t id) {
+        auto it = connections.find(id);
+        if (it == connections.end()) return;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        ::close(it->second.fd);
+        connections.erase(it);
+    }
+
+    void accept(size_t engine) {
+        while (true) {
+            int fd = accept4(listeners[engine], nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;   // EAGAIN - очередь принятия пуста
+            uint64_t id = nextConnection++;
+            Connection& connection = connections[id];
+            connection.fd = fd;
+            connection.engine = engine;
+            connection.events = EPOLLIN;
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = id;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        }
+    }
+
+    // Все полные строки (а после закрытия клиентом - и хвост) уходят одной задачей
+    void dispatch(uint64_t id, Connection& connection) {
+        size_t end = connection.input.rfind('\n');
+        Job job{id, connection.engine, {}, {}};
+        if (connection.peerClosed && !connection.input.empty()) {
+            job.lines.swap(connection.input);
+        } else if (end != string::npos) {
+            job.lines.assign(connection.input, 0, end);
+            connection.input.erase(0, end + 1);
+        } else {
+            return;
+        }
+        ++connection.inFlight;
+        workers[workerOf[connection.engine]]->submit(move(job));
+    }
+
+    void read(uint64_t id, Connection& connection) {
+        char buffer[READ_CHUNK];
+        while (true) {
+            ssize_t n = ::read(connection.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                connection.input.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0) connection.peerClosed = true;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK) connection.peerClosed = true;
+            break;
+        }
+        if (connection.input.size() > MAX_PENDING_INPUT) {
+            close(id);
+            return;
+        }
+        dispatch(id, connection);
+        finish(id, connection);
+    }
+
+    // Отправка накопленных ответов, сколько примет сокет
+    void write(uint64_t id, Connection& connection) {
+        while (connection.sent < connection.output.size()) {
+            ssize_t n = send(connection.fd, connection.output.data() + connection.sent,
+                             connection.output.size() - connection.sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                connection.sent += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            close(id);   // Клиент ушел, не дочитав ответы
+            return;
+        }
+        if (connection.sent == connection.output.size()) {
+            connection.output.clear();
+            connection.sent = 0;
+        }
+        finish(id, connection);
+    }
+
+    // Закрытие после того, как клиент закрыл свою сторону и получил все ответы;
+    // иначе - обновление подписки epoll
+    void finish(uint64_t id, Connection& connection) {
+        if (connection.peerClosed && connection.inFlight == 0 && connection.output.empty()) {
+            close(id);
+            return;
+        }
+        subscribe(id, connection);
+    }
+
+    void collectCompletions() {
+        uint64_t counter;
+        ssize_t n = ::read(eventFd, &counter, sizeof(counter));
+        (void)n;
+        vector<Job> done;
+        completions.take(done);
+        for (Job& job : done) {
+            auto it = connections.find(job.connection);
+            if (it == connections.end()) continue;   // Соединение уже закрыто
+            --it->second.inFlight;
+            it->second.output += job.responses;
+        }
+        // Ответы всех пришедших задач соединения отправляются вместе
+        for (Job& job : done) {
+            auto it = connections.find(job.connection);
+            if (it == connections.end()) continue;
+            if (it->second.sent < it->second.output.size()) write(job.connection, it->second);
+            else if (it->second.inFlight == 0) finish(job.connection, it->second);
+        }
+    }
+
+    int listen(const string& path) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (fd < 0 || path.size() >= sizeof(address.sun_path)) {
+            throw runtime_error("Cannot create socket " + path);
+        }
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, 128) < 0) {
+            throw runtime_error("Cannot listen on " + path + ": " + strerror(errno));
+        }
+        return fd;
+    }
+
+public:
+    Server(const string& socketDir, size_t workerCount, const EngineOptions& options)
+        : epollFd(epoll_create1(EPOLL_CLOEXEC)),
+          eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          signalFd(-1),
+          completions(eventFd) {
+        engines.push_back(makeWarehouseEngine(options));
+        engines.push_back(makeQueueEngine(options));
+        engines.push_back(makeTramEngine(options));
+        engines.push_back(makeRegionEngine(options));
+
+        // SIGINT/SIGTERM приходят в цикл epoll через signalfd
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+        // Потоки создаются после блокировки сигналов и наследуют маску
+        unsigned cpus = max(1u, thread::hardware_concurrency());
+        workerCount = max<size_t>(1, min(workerCount, engines.size()));
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers.push_back(make_unique<Worker>(engines, completions, static_cast<int>(i % cpus)));
+        }
+        for (size_t i = 0; i < engines.size(); ++i) workerOf.push_back(i % workerCount);
+
+        mkdir(socketDir.c_str(), 0755);
+        for (size_t i = 0; i < engines.size(); ++i) {
+            socketPaths.push_back(socketDir + "/" + engines[i]->name() + ".sock");
+            listeners.push_back(listen(socketPaths.back()));
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = i;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, listeners.back(), &event);
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = EVENT_TAG;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &event);
+        event.data.u64 = SIGNAL_TAG;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, signalFd, &event);
+    }
+
+    ~Server() {
+        workers.clear();   // Дожидаемся задач, которые уже выполняются
+        for (auto& [id, connection] : connections) ::close(connection.fd);
+        for (size_t i = 0; i < listeners.size(); ++i) {
+            ::close(listeners[i]);
+            unlink(socketPaths[i].c_str());
+        }
+        ::close(signalFd);
+        ::close(eventFd);
+        ::close(epollFd);
+    }
+
+    const vector<string>& sockets() const {
+        return socketPaths;
+    }
+
+    void run() {
+        epoll_event events[256];
+        while (running) {
+            int count = epoll_wait(epollFd, events, 256, -1);
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0) break;
+            for (int i = 0; i < count; ++i) {
+                uint64_t tag = events[i].data.u64;
+                if (tag < engines.size()) {
+                    accept(tag);
+                } else if (tag == EVENT_TAG) {
+                    collectCompletions();
+                } else if (tag == SIGNAL_TAG) {
+                    running = false;
+                } else {
+                    auto it = connections.find(tag);
+                    if (it == connections.end()) continue;
+                    // Клиент закрыл соединение полностью: ответы доставить уже некуда
+                    if ((events[i].events & EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                        close(tag);
+                        continue;
+                    }
+                    if (events[i].events & (EPOLLOUT | EPOLLERR)) write(tag, it->second);
+                    it = connections.find(tag);
+                    if (it == connections.end()) continue;
+                    if (events[i].events & (EPOLLIN | EPOLLERR)) read(tag, it->second);
+                }
+            }
+        }
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    string socketDir = "/tmp/lab5";
+    size_t workerCount = 4;
+    EngineOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string_view arg = argv[i];
+        if (arg == "--socket-dir" && i + 1 < argc) socketDir = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) workerCount = static_cast<size_t>(max(1, atoi(argv[++i])));
+        else if (arg == "--data" && i + 1 < argc) options.warehouseData = argv[++i];
+        else if (arg == "--windows" && i + 1 < argc) options.queueWindows = max(1, atoi(argv[++i]));
+        else if (arg == "--tram-data" && i + 1 < argc) options.tramData = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0]
+                 << " [--socket-dir <dir>] [--workers <n>] [--data <dir>] [--windows <n>] [--tram-data <dir>]\n";
+            return 1;
+        }
+    }
+
+    try {
+        Server server(socketDir, workerCount, options);
+        for (const string& path : server.sockets()) cout << "Listening on " << path << "\n";
+        cout.flush();
+        server.run();
+    } catch (const exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
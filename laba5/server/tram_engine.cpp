@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "engine.h"
+#include "../ex3/tram_manager.h"
+#include "../ex3/journey_planner.h"
+#include "../ex3/command_processor.h"
+
+using namespace std;
+
+namespace {
+
+// Файл LOAD/DUMP внутри каталога данных; пустая строка - имя недопустимо.
+// Клиент сокета не должен читать и писать произвольные файлы от имени сервера,
+// поэтому абсолютные пути и компоненты ".." отклоняются
+string dataPath(const string& dataDir, const string& name) {
+    if (dataDir.empty() || name.empty() || name[0] == '/') return "";
+    for (size_t begin = 0; begin <= name.size();) {
+        size_t end = min(name.find('/', begin), name.size());
+        if (name.compare(begin, end - begin, "..") == 0) return "";
+        begin = end + 1;
+    }
+    return dataDir + "/" + name;
+}
+
+// Трамвайная сеть (ex3) собирается из ее объектных файлов без main.cpp;
+// ответы и ошибки команды идут клиенту одним потоком.
+// Сеть принадлежит одному рабочему потоку (см. engine.h), других читателей нет,
+// поэтому снимки ConcurrentTramManager здесь не нужны: они стоили бы копии всей
+// сети на каждую пачку с изменениями. Команды изменяют сеть на месте.
+class TramEngine : public Engine {
+private:
+    TramManager manager;
+    JourneyPlanner planner{manager};
+    ostringstream output;
+    string dataDir;
+
+public:
+    explicit TramEngine(const EngineOptions& options) : dataDir(options.tramData) {}
+
+    const char* name() const override {
+        return "trams";
+    }
+
+    void execute(string_view line, string& response) override {
+        if (line.empty()) return;
+
+        istringstream iss{string(line)};
+        string inputCmd;
+        iss >> inputCmd;
+
+        // EXIT в сервере ничего не делает: сеанс завершает клиент, закрывая соединение
+        Command cmd = parseCommand(inputCmd);
+        if (cmd == Command::UNKNOWN) {
+            output << "ERROR: Unknown command\n";
+            printHelp(output);
+        } else if (cmd == Command::LOAD || cmd == Command::DUMP) {
+            // Имя файла заменяется путем внутри каталога --tram-data
+            string name;
+            iss >> name;
+            string path = dataPath(dataDir, name);
+            if (dataDir.empty()) {
+                output << "ERROR: LOAD and DUMP are disabled (server started without --tram-data)\n";
+            } else if (name.empty()) {
+                output << "ERROR: Missing file name\n";
+            } else if (path.empty()) {
+                output << "ERROR: File name must be relative to the data directory and must not contain '..'\n";
+            } else {
+                istringstream resolved(path);
+                processCommand(cmd, resolved, manager, planner, output, output);
+            }
+        } else {
+            processCommand(cmd, iss, manager, planner, output, output);
+        }
+        response += output.str();
+        output.str("");
+    }
+};
+
+}
+
+unique_ptr<Engine> makeTramEngine(const EngineOptions& options) {
+    return make_unique<TramEngine>(options);
+}
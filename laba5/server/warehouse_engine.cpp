@@ -0,0 +1,44 @@
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../warehouse.h"
+#include "engine.h"
+
+using namespace std;
+
+namespace {
+
+// Склад один на сервер, его команды выполняет один рабочий поток
+class WarehouseEngine : public Engine {
+private:
+    ex1::Warehouse warehouse;
+    ex1::OutputBuffer out;
+    vector<string_view> tokens;
+
+public:
+    explicit WarehouseEngine(const EngineOptions& options) {
+        if (!options.warehouseData.empty()) warehouse.openStorage(options.warehouseData);
+    }
+
+    const char* name() const override {
+        return "warehouse";
+    }
+
+    void execute(string_view line, string& response) override {
+        ex1::processLine(line, tokens, warehouse, out);
+        response += out.data;
+        out.data.clear();
+    }
+
+    // Как в пакетном режиме ex1: ответы уходят только после записи журнала на диск
+    void commit() override {
+        ex1::commitCommands(warehouse);
+    }
+};
+
+}
+
+unique_ptr<Engine> makeWarehouseEngine(const EngineOptions& options) {
+    return make_unique<WarehouseEngine>(options);
+}
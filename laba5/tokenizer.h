@@ -0,0 +1,224 @@
+// tokenizer.h
+// Разбор команд для всех лабораторных: поиск пробельных символов блоками по
+// 32 (AVX2) или 16 (SSE2) байт с обычным циклом для хвоста и для сборки без
+// SIMD, токены - string_view на исходный буфер, ключевые слова команд
+// распознаются совершенным хешем, который подбирается при компиляции по
+// набору команд программы. Только заголовок.
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace tokenizer {
+
+// Пробельные символы как у isspace в локали "C": пробел и '\t'..'\r'
+inline bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+namespace detail {
+
+// Маска пробельных символов блока: c == ' ' или (c - '\t') <= 4 без знака
+#if defined(__AVX2__)
+constexpr size_t BLOCK = 32;
+
+inline uint32_t spaceMask(const char* p) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    __m256i blank = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control, blank)));
+}
+#elif defined(__SSE2__)
+constexpr size_t BLOCK = 16;
+
+inline uint32_t spaceMask(const char* p) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+    __m128i blank = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(control, blank)));
+}
+#else
+constexpr size_t BLOCK = 0;
+#endif
+
+// Первый символ в [p, end), для которого isSpace(c) == space; end, если такого нет
+template <bool space>
+inline const char* scan(const char* p, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    // Токены короткие, поэтому сначала проверяется несколько символов без SIMD
+    for (int i = 0; i < 4 && p < end; ++i, ++p) {
+        if (isSpace(*p) == space) return p;
+    }
+    while (static_cast<size_t>(end - p) >= BLOCK) {
+        uint32_t mask = spaceMask(p);
+        if (!space) mask = ~mask & static_cast<uint32_t>((uint64_t(1) << BLOCK) - 1);
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += BLOCK;
+    }
+#endif
+    while (p < end && isSpace(*p) != space) ++p;
+    return p;
+}
+
+}
+
+// Первый пробельный символ в [p, end) или end
+inline const char* findSpace(const char* p, const char* end) {
+    return detail::scan<true>(p, end);
+}
+
+// Первый непробельный символ в [p, end) или end
+inline const char* skipSpace(const char* p, const char* end) {
+    return detail::scan<false>(p, end);
+}
+
+// Последовательный разбор текста без копирования: токены ссылаются на исходный буфер.
+// token() ведет себя как cin >>, restOfLine() - как getline.
+class Tokenizer {
+protected:
+    const char* position;
+    const char* end;
+
+public:
+    explicit Tokenizer(std::string_view text) : position(text.data()), end(text.data() + text.size()) {}
+
+    // Следующий токен, переводы строк пропускаются; пустой в конце текста
+    std::string_view token() {
+        const char* begin = skipSpace(position, end);
+        position = findSpace(begin, end);
+        return std::string_view(begin, static_cast<size_t>(position - begin));
+    }
+
+    // Остаток текущей строки; перевод строки пропускается
+    std::string_view restOfLine() {
+        const char* begin = position;
+        const void* newline = std::memchr(position, '\n', static_cast<size_t>(end - position));
+        const char* lineEnd = newline ? static_cast<const char*>(newline) : end;
+        position = newline ? lineEnd + 1 : end;
+        return std::string_view(begin, static_cast<size_t>(lineEnd - begin));
+    }
+
+    // Первый токен остатка строки (пустой, если его нет)
+    std::string_view tokenInRestOfLine() {
+        Tokenizer line(restOfLine());
+        return line.token();
+    }
+
+    void skipChar() {
+        if (position < end) ++position;
+    }
+
+    bool atEnd() const {
+        return position == end;
+    }
+};
+
+// Разбиение строки на токены
+inline void split(std::string_view line, std::vector<std::string_view>& tokens) {
+    tokens.clear();
+    Tokenizer tokenizer(line);
+    for (std::string_view token = tokenizer.token(); !token.empty(); token = tokenizer.token()) {
+        tokens.push_back(token);
+    }
+}
+
+// Ключевое слово команды и связанное с ним значение
+template <typename Value>
+struct Keyword {
+    std::string_view name;
+    Value value;
+};
+
+// Таблица ключевых слов с совершенным хешем. Конструктор (constexpr) перебирает
+// затравку хеша, пока все слова не попадут в разные ячейки таблицы размером
+// не меньше 4N, поэтому поиск - один хеш и одно сравнение. Регистр букв учитывается
+// при сравнении только при ignoreCase == false; хеш от него не зависит.
+template <typename Value, size_t N, bool ignoreCase>
+class KeywordTable {
+public:
+    static constexpr size_t SIZE = [] {
+        size_t size = 1;
+        while (size < 4 * N) size *= 2;
+        return size;
+    }();
+
+    constexpr KeywordTable(const Keyword<Value> (&keywords)[N], Value missing) : missing(missing) {
+        for (uint32_t candidate = 1;; ++candidate) {
+            std::array<bool, SIZE> used{};
+            bool perfect = true;
+            for (size_t i = 0; i < N && perfect; ++i) {
+                size_t index = hash(keywords[i].name, candidate) & (SIZE - 1);
+                perfect = !used[index];
+                used[index] = true;
+            }
+            if (perfect) {
+                seed = candidate;
+                break;
+            }
+        }
+        for (size_t i = 0; i < N; ++i) {
+            slots[hash(keywords[i].name, seed) & (SIZE - 1)] = {keywords[i].name, keywords[i].value, true};
+        }
+    }
+
+    // Значение слова; missing, если слова нет в таблице
+    constexpr Value find(std::string_view word) const {
+        const Slot& slot = slots[hash(word, seed) & (SIZE - 1)];
+        if (!slot.used || slot.name.size() != word.size()) return missing;
+        for (size_t i = 0; i < word.size(); ++i) {
+            char a = word[i];
+            char b = slot.name[i];
+            if (ignoreCase) {
+                a = upper(a);
+                b = upper(b);
+            }
+            if (a != b) return missing;
+        }
+        return slot.value;
+    }
+
+private:
+    struct Slot {
+        std::string_view name;
+        Value value{};
+        bool used = false;
+    };
+
+    std::array<Slot, SIZE> slots{};
+    Value missing;
+    uint32_t seed = 0;
+
+    static constexpr char upper(char c) {
+        return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+    // FNV-1a по буквам, приведенным к одному регистру (c | 0x20)
+    static constexpr uint32_t hash(std::string_view word, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (size_t i = 0; i < word.size(); ++i) {
+            h = (h ^ static_cast<unsigned char>(word[i] | 0x20)) * 16777619u;
+        }
+        return h ^ (h >> 16);
+    }
+};
+
+// Таблица строится при компиляции, если результат объявлен constexpr:
+//     constexpr auto commands = tokenizer::makeKeywordTable<Command>({{"ADD", Command::ADD}, ...}, Command::UNKNOWN);
+template <typename Value, bool ignoreCase = true, size_t N>
+constexpr KeywordTable<Value, N, ignoreCase> makeKeywordTable(const Keyword<Value> (&keywords)[N], Value missing) {
+    return KeywordTable<Value, N, ignoreCase>(keywords, missing);
+}
+
+}
+
+#endif
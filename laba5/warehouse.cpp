@@ -0,0 +1,1127 @@
+// warehouse.cpp
+#include "warehouse.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tokenizer.h"
+
+using namespace std;
+
+namespace ex1 {
+
+// Таблица "символ зоны -> индекс зоны" (-1 для неизвестных символов)
+const array<int, 256> zoneIndex = [] {
+    array<int, 256> table;
+    table.fill(-1);
+    for (size_t zone = 0; zone < ZONES.size(); ++zone) {
+        table[static_cast<unsigned char>(ZONES[zone])] = zone;
+    }
+    return table;
+}();
+
+// Преобразование адреса вида "A1234" в номер ячейки; -1, если адрес не существует
+int encodeAddress(string_view address) {
+    // Минимум: зона + стеллаж + секция + полка
+    if (address.size() < 4 || address.size() > 5) return -1;
+    int zone = zoneIndex[static_cast<unsigned char>(address[0])];
+    if (zone < 0) return -1;
+
+    for (size_t i = 1; i < address.size(); ++i) {
+        if (address[i] < '0' || address[i] > '9') return -1;
+    }
+    // Номер стеллажа пишется без ведущего нуля
+    if (address[1] == '0') return -1;
+
+    int shelf = address[1] - '0';
+    if (address.size() == 5) shelf = shelf * 10 + (address[2] - '0');
+    int section = address[address.size() - 2] - '0';
+    int rack = address[address.size() - 1] - '0';
+    if (shelf > SHELVES || section < 1 || section > SECTIONS || rack < 1 || rack > RACKS) return -1;
+
+    return ((zone * SHELVES + shelf - 1) * SECTIONS + section - 1) * RACKS + rack - 1;
+}
+
+// Обратное преобразование номера ячейки в адрес
+string decodeAddress(int slot) {
+    int rack = slot % RACKS + 1;
+    slot /= RACKS;
+    int section = slot % SECTIONS + 1;
+    slot /= SECTIONS;
+    int shelf = slot % SHELVES + 1;
+    int zone = slot / SHELVES;
+    return string(1, ZONES[zone]) + to_string(shelf) + to_string(section) + to_string(rack);
+}
+
+// Адреса всех ячеек с их номерами, упорядоченные как строки ("A1011" < "A111").
+// В этом порядке INFO выводит списки ячеек, как исходная версия со словарем
+// map<string, Cell>. Строится один раз при первом обращении.
+const vector<pair<string, int>>& addressOrder() {
+    static const vector<pair<string, int>> order = [] {
+        vector<pair<string, int>> addresses;
+        addresses.reserve(CELL_COUNT);
+        for (int slot = 0; slot < CELL_COUNT; ++slot) addresses.emplace_back(decodeAddress(slot), slot);
+        sort(addresses.begin(), addresses.end());
+        return addresses;
+    }();
+    return order;
+}
+
+// Число и время выполнения команд (и фиксаций журнала), выводятся командой STATS
+instrumentation::CommandStats commandStats;
+
+bool parseQuantity(string_view token, int& quantity) {
+    // from_chars не принимает '+', stoi - принимает
+    const char* begin = token.data();
+    const char* end = token.data() + token.size();
+    if (begin != end && *begin == '+') ++begin;
+    auto result = from_chars(begin, end, quantity);
+    return result.ec == errc() && quantity > 0;
+}
+
+// Журнал упреждающей записи (WAL). Каждое успешное изменение ячейки пишется как
+// итоговое состояние ячейки, поэтому повтор записи идемпотентен. Записи копятся
+// в памяти и сбрасываются на диск групповым коммитом: один fdatasync на пачку операций.
+//
+// Журнал делится на сегменты warehouse-<первый LSN>.wal. При снимке открывается
+// новый сегмент, а сегменты, целиком попавшие в снимок, удаляются.
+const uint32_t WAL_MAGIC = 0x4c415757;       // "WWAL"
+const uint64_t SNAPSHOT_MAGIC = 0x31504e5348525741ULL;  // "AWRHSNP1"
+const uint64_t SNAPSHOT_INTERVAL = 1 << 20;  // записей журнала между снимками
+
+enum WalRecordKind : uint8_t {
+    WAL_CELL = 1,   // новое состояние ячейки
+    WAL_ITEM = 2,   // регистрация названия товара, за записью следует название
+    WAL_GROUP = 3,  // следующие slot записей применяются при восстановлении вместе или не применяются
+};
+
+struct WalSegmentHeader {
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t firstLsn;
+};
+
+struct WalRecord {
+    uint32_t slot;       // номер ячейки; для WAL_ITEM - длина названия
+    uint32_t itemId;
+    uint8_t kind;
+    uint8_t quantity;
+    uint16_t reserved;
+    uint32_t checksum;   // FNV-1a по записи (с нулевым checksum) и названию
+};
+
+struct SnapshotHeader {
+    uint64_t magic;
+    uint64_t lsn;        // последняя запись журнала, вошедшая в снимок
+    uint32_t cellCount;
+    uint32_t itemCount;
+};
+
+// Новое состояние одной ячейки в группе изменений
+struct CellChange {
+    int slot;
+    uint32_t itemId;
+    int quantity;
+};
+
+uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+uint32_t walChecksum(WalRecord record, string_view name) {
+    record.checksum = 0;
+    return fnv1a(name.data(), name.size(), fnv1a(&record, sizeof(record)));
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Файл, отображенный в память только для чтения
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const char*>(mapped);
+                size = info.st_size;
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data) munmap(const_cast<char*>(data), size);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+// Чтение записи журнала по смещению pos; false, если запись неполная или поврежденная
+bool readWalRecord(const MappedFile& file, size_t pos, WalRecord& record, string_view& name) {
+    if (pos + sizeof(record) > file.size) return false;
+    memcpy(&record, file.data + pos, sizeof(record));
+    size_t nameLength = record.kind == WAL_ITEM ? record.slot : 0;
+    if (pos + sizeof(record) + nameLength > file.size) return false;
+    name = string_view(file.data + pos + sizeof(record), nameLength);
+    return walChecksum(record, name) == record.checksum;
+}
+
+string walSegmentPath(const string& dir, uint64_t firstLsn) {
+    char name[64];
+    snprintf(name, sizeof(name), "/warehouse-%020llu.wal", (unsigned long long)firstLsn);
+    return dir + name;
+}
+
+// Первые LSN всех сегментов журнала в каталоге, по возрастанию
+vector<uint64_t> listWalSegments(const string& dir) {
+    vector<uint64_t> segments;
+    if (DIR* handle = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(handle)) {
+            unsigned long long firstLsn;
+            char tail;
+            if (sscanf(entry->d_name, "warehouse-%20llu.wa%c", &firstLsn, &tail) == 2 && tail == 'l') {
+                segments.push_back(firstLsn);
+            }
+        }
+        closedir(handle);
+    }
+    sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void syncDirectory(const string& dir) {
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+class WriteAheadLog {
+private:
+    string dir;
+    int fd = -1;
+    uint64_t segmentFirstLsn = 0;
+
+    mutex appendLock;              // защищает buffer и nextLsn
+    string buffer;
+    uint64_t nextLsn = 1;
+    uint64_t lastSnapshotLsn = 0;
+
+    mutex syncLock;                // один поток пишет на диск, остальные ждут его результата
+    atomic<uint64_t> durableLsn{0};
+
+    void openSegment(uint64_t firstLsn) {
+        segmentFirstLsn = firstLsn;
+        fd = open(walSegmentPath(dir, firstLsn).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (fd < 0) {
+            perror("Ошибка: не удалось открыть журнал");
+            exit(1);
+        }
+        WalSegmentHeader header = {WAL_MAGIC, 0, firstLsn};
+        writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+        syncDirectory(dir);
+    }
+
+    // Запись накопленного буфера на диск; вызывается под syncLock
+    void flushLocked() {
+        string pending;
+        uint64_t lastLsn;
+        {
+            lock_guard<mutex> guard(appendLock);
+            pending.swap(buffer);
+            lastLsn = nextLsn - 1;
+        }
+        if (lastLsn <= durableLsn) return;
+        if (!writeAll(fd, pending.data(), pending.size()) || fdatasync(fd) != 0) {
+            perror("Ошибка: не удалось записать журнал");
+            exit(1);
+        }
+        durableLsn = lastLsn;
+    }
+
+public:
+    ~WriteAheadLog() {
+        if (fd >= 0) {
+            sync();
+            close(fd);
+        }
+    }
+
+    // Начало записи после восстановления: новый сегмент открывается с LSN, следующего за lastLsn
+    void start(const string& directory, uint64_t lastLsn, uint64_t snapshotLsn) {
+        dir = directory;
+        nextLsn = lastLsn + 1;
+        durableLsn = lastLsn;
+        lastSnapshotLsn = snapshotLsn;
+        openSegment(nextLsn);
+    }
+
+    uint64_t appendCell(int slot, uint32_t itemId, int quantity) {
+        WalRecord record = {uint32_t(slot), itemId, WAL_CELL, uint8_t(quantity), 0, 0};
+        record.checksum = walChecksum(record, {});
+        lock_guard<mutex> guard(appendLock);
+        buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        return nextLsn++;
+    }
+
+    // Группа изменений пишется одним куском под блокировкой, чтобы записи других
+    // потоков не попали внутрь нее. Возвращает LSN последней записи группы.
+    uint64_t appendGroup(const CellChange* changes, size_t count) {
+        WalRecord header = {uint32_t(count), 0, WAL_GROUP, 0, 0, 0};
+        header.checksum = walChecksum(header, {});
+        lock_guard<mutex> guard(appendLock);
+        buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (size_t i = 0; i < count; ++i) {
+            WalRecord record = {uint32_t(changes[i].slot), changes[i].itemId, WAL_CELL, uint8_t(changes[i].quantity), 0, 0};
+            record.checksum = walChecksum(record, {});
+            buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+        nextLsn += count + 1;
+        return nextLsn - 1;
+    }
+
+    uint64_t appendItem(uint32_t itemId, string_view name) {
+        WalRecord record = {uint32_t(name.size()), itemId, WAL_ITEM, 0, 0, 0};
+        record.checksum = walChecksum(record, name);
+        lock_guard<mutex> guard(appendLock);
+        buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        buffer.append(name);
+        return nextLsn++;
+    }
+
+    // Групповой коммит: если пока поток ждал syncLock, его записи уже сбросил
+    // другой поток, повторный fdatasync не нужен
+    void sync() {
+        uint64_t target;
+        {
+            lock_guard<mutex> guard(appendLock);
+            target = nextLsn - 1;
+        }
+        if (durableLsn >= target) return;
+        lock_guard<mutex> guard(syncLock);
+        if (durableLsn >= target) return;
+        flushLocked();
+    }
+
+    bool snapshotDue() {
+        lock_guard<mutex> guard(appendLock);
+        return nextLsn - 1 - lastSnapshotLsn >= SNAPSHOT_INTERVAL;
+    }
+
+    // Переход на новый сегмент. Вызывается, когда все шарды и реестр товаров
+    // заблокированы, поэтому новых записей в это время нет. Возвращает последний LSN.
+    uint64_t rotate() {
+        lock_guard<mutex> guard(syncLock);
+        flushLocked();
+        close(fd);
+        lock_guard<mutex> appendGuard(appendLock);
+        openSegment(nextLsn);
+        lastSnapshotLsn = nextLsn - 1;
+        return lastSnapshotLsn;
+    }
+
+    // Удаление сегментов, все записи которых уже вошли в снимок
+    void removeSegmentsBefore(uint64_t firstLsn) {
+        for (uint64_t segment : listWalSegments(dir)) {
+            if (segment < firstLsn) unlink(walSegmentPath(dir, segment).c_str());
+        }
+    }
+};
+
+uint32_t ItemRegistry::intern(string_view item) {
+    if (uint32_t id = find(item)) return id;
+    unique_lock<shared_mutex> guard(lock);
+    auto it = ids.find(item);
+    if (it != ids.end()) return it->second;
+    uint32_t id = names.size();
+    names.emplace_back(item);
+    ids.emplace(names.back(), id);
+    if (log) log->appendItem(id, item);
+    return id;
+}
+
+ZoneShard::ZoneShard() {
+    cells.itemId.assign(CELLS_PER_ZONE, 0);
+    cells.quantity.assign(CELLS_PER_ZONE, 0);
+    cells.occupied.assign(WORDS_PER_ZONE, 0);
+    freeWords.assign((WORDS_PER_ZONE + 63) / 64, 0);
+    for (int word = 0; word < WORDS_PER_ZONE; ++word) {
+        freeWords[word / 64] |= uint64_t(1) << (word % 64);
+    }
+    itemCellPos.assign(CELLS_PER_ZONE, -1);
+}
+
+void ZoneShard::removeFromItemIndex(uint32_t item, int cell) {
+    vector<int>& list = itemCells[item];
+    int pos = itemCellPos[cell];
+    list[pos] = list.back();
+    itemCellPos[list[pos]] = pos;
+    list.pop_back();
+}
+
+void ZoneShard::setCell(int cell, uint32_t item, int quantity) {
+    cells.totalItems += quantity - cells.quantity[cell];
+
+    int word = cell / 64;
+    uint64_t bit = uint64_t(1) << (cell % 64);
+    bool wasOccupied = cells.quantity[cell] > 0;
+    uint32_t oldItem = cells.itemId[cell];
+    if (!wasOccupied && quantity > 0) {
+        cells.occupied[word] |= bit;
+        ++cells.occupiedCount;
+    } else if (wasOccupied && quantity == 0) {
+        cells.occupied[word] &= ~bit;
+        --cells.occupiedCount;
+    }
+
+    uint64_t freeBit = uint64_t(1) << (word % 64);
+    if (cells.occupied[word] == validCellsMask(word)) freeWords[word / 64] &= ~freeBit;
+    else freeWords[word / 64] |= freeBit;
+
+    if (wasOccupied && (quantity == 0 || oldItem != item)) removeFromItemIndex(oldItem, cell);
+    if (quantity > 0 && (!wasOccupied || oldItem != item)) addToItemIndex(item, cell);
+
+    cells.quantity[cell] = quantity;
+    cells.itemId[cell] = quantity > 0 ? item : 0;
+}
+
+int ZoneShard::firstEmptyCell(int from) const {
+    if (from >= CELLS_PER_ZONE) return -1;
+    int startWord = from / 64;
+    uint64_t bits = ~cells.occupied[startWord] & validCellsMask(startWord);
+    bits &= ~uint64_t(0) << (from % 64);
+    if (bits != 0) return startWord * 64 + __builtin_ctzll(bits);
+
+    for (size_t index = (startWord + 1) / 64; index < freeWords.size(); ++index) {
+        uint64_t candidates = freeWords[index];
+        if (index == size_t(startWord + 1) / 64) candidates &= ~uint64_t(0) << ((startWord + 1) % 64);
+        if (candidates != 0) {
+            int word = index * 64 + __builtin_ctzll(candidates);
+            return word * 64 + __builtin_ctzll(~cells.occupied[word] & validCellsMask(word));
+        }
+    }
+    return -1;
+}
+
+// План уплотнения частично заполненных ячеек одного товара; cells - номера ячеек
+// и количества по возрастанию номера. Ячейки упорядочиваются по убыванию
+// количества (при равенстве - ближние к началу склада первыми), затем самая
+// заполненная ячейка добирает товар из самой пустой. Каждое перемещение либо
+// заполняет ячейку до конца, либо опустошает источник, поэтому перемещений не
+// больше k - 1, частично заполненной остается не более одной ячейки, а пустыми
+// становятся k - ceil(S / CELL_CAPACITY) ячеек - больше освободить нельзя.
+// Корзины по количеству дают O(k) на товар.
+void planCompaction(const vector<pair<int, int>>& cells, vector<CellMove>& moves) {
+    array<vector<int>, CELL_CAPACITY> byQuantity;
+    for (const auto& [slot, quantity] : cells) byQuantity[quantity].push_back(slot);
+
+    vector<pair<int, int>> order;
+    order.reserve(cells.size());
+    for (int quantity = CELL_CAPACITY - 1; quantity > 0; --quantity) {
+        for (int slot : byQuantity[quantity]) order.emplace_back(slot, quantity);
+    }
+
+    size_t target = 0;
+    size_t source = order.size();
+    while (source > 0 && target < source - 1) {
+        auto& [to, toQuantity] = order[target];
+        auto& [from, fromQuantity] = order[source - 1];
+        int moved = min(CELL_CAPACITY - toQuantity, fromQuantity);
+        moves.push_back({from, to, moved});
+        toQuantity += moved;
+        fromQuantity -= moved;
+        if (toQuantity == CELL_CAPACITY) ++target;
+        if (fromQuantity == 0) --source;
+    }
+}
+
+Warehouse::Warehouse() : shards(ZONES.size()) {}
+
+Warehouse::~Warehouse() = default;
+
+void Warehouse::setCell(int slot, uint32_t id, int quantity) {
+    shards[slot / CELLS_PER_ZONE].setCell(slot % CELLS_PER_ZONE, id, quantity);
+    if (wal) wal->appendCell(slot, id, quantity);
+}
+
+void Warehouse::moveCell(int from, int to, uint32_t id, int quantity) {
+    ZoneShard& source = shards[from / CELLS_PER_ZONE];
+    ZoneShard& target = shards[to / CELLS_PER_ZONE];
+    CellChange changes[] = {
+        {from, id, source.cells.quantity[from % CELLS_PER_ZONE] - quantity},
+        {to, id, target.cells.quantity[to % CELLS_PER_ZONE] + quantity},
+    };
+    source.setCell(from % CELLS_PER_ZONE, id, changes[0].quantity);
+    target.setCell(to % CELLS_PER_ZONE, id, changes[1].quantity);
+    if (wal) wal->appendGroup(changes, 2);
+}
+
+uint64_t Warehouse::loadSnapshot() {
+    MappedFile file(snapshotPath());
+    if (!file.data) return 0;
+
+    SnapshotHeader header;
+    if (file.size < sizeof(header)) return 0;
+    memcpy(&header, file.data, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.cellCount != uint32_t(CELL_COUNT)) {
+        fprintf(stderr, "Ошибка: снимок %s не подходит к текущей схеме склада\n", snapshotPath().c_str());
+        exit(1);
+    }
+
+    // Снимок читается только после проверки размеров: оборванный или чужой файл
+    // не должен приводить к чтению за концом отображения
+    auto corrupted = [this] {
+        fprintf(stderr, "Ошибка: снимок %s поврежден\n", snapshotPath().c_str());
+        exit(1);
+    };
+    const char* end = file.data + file.size;
+    if (file.size < sizeof(header) + (sizeof(uint32_t) + 1) * size_t(CELL_COUNT) || header.itemCount == 0) corrupted();
+
+    const char* itemIds = file.data + sizeof(header);
+    const uint8_t* quantities = reinterpret_cast<const uint8_t*>(itemIds + sizeof(uint32_t) * CELL_COUNT);
+    const char* name = reinterpret_cast<const char*>(quantities + CELL_COUNT);
+    for (uint32_t id = 1; id < header.itemCount; ++id) {
+        uint32_t length;
+        if (size_t(end - name) < sizeof(length)) corrupted();
+        memcpy(&length, name, sizeof(length));
+        if (size_t(end - name) - sizeof(length) < length) corrupted();
+        items.restore(id, string_view(name + sizeof(length), length));
+        name += sizeof(length) + length;
+    }
+    for (int slot = 0; slot < CELL_COUNT; ++slot) {
+        uint32_t id;
+        memcpy(&id, itemIds + sizeof(uint32_t) * slot, sizeof(id));
+        uint8_t quantity = quantities[slot];
+        if (quantity > CELL_CAPACITY || (quantity > 0 && (id == 0 || id >= header.itemCount))) corrupted();
+        if (quantity > 0) shards[slot / CELLS_PER_ZONE].setCell(slot % CELLS_PER_ZONE, id, quantity);
+    }
+    return header.lsn;
+}
+
+bool Warehouse::groupComplete(const MappedFile& file, size_t pos, uint32_t count) {
+    WalRecord record;
+    string_view name;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!readWalRecord(file, pos, record, name)) return false;
+        pos += sizeof(record) + name.size();
+    }
+    return true;
+}
+
+uint64_t Warehouse::replayLog(uint64_t snapshotLsn, uint64_t& replayed) {
+    uint64_t lastLsn = snapshotLsn;
+    for (uint64_t segment : listWalSegments(dataDir)) {
+        MappedFile file(walSegmentPath(dataDir, segment));
+        WalSegmentHeader header;
+        if (file.size < sizeof(header)) continue;
+        memcpy(&header, file.data, sizeof(header));
+        if (header.magic != WAL_MAGIC || header.firstLsn != segment) continue;
+
+        uint64_t lsn = header.firstLsn;
+        size_t pos = sizeof(header);
+        WalRecord record;
+        string_view name;
+        while (readWalRecord(file, pos, record, name)) {
+            // Группа без хотя бы одной своей записи - оборванный хвост, он не применяется
+            if (record.kind == WAL_GROUP && !groupComplete(file, pos + sizeof(record), record.slot)) break;
+
+            if (lsn > snapshotLsn) {
+                if (record.kind == WAL_ITEM) {
+                    items.restore(record.itemId, name);
+                } else if (record.kind == WAL_CELL && record.slot < uint32_t(CELL_COUNT) && record.quantity <= CELL_CAPACITY) {
+                    shards[record.slot / CELLS_PER_ZONE].setCell(record.slot % CELLS_PER_ZONE, record.itemId, record.quantity);
+                }
+                ++replayed;
+            }
+            lastLsn = max(lastLsn, lsn);
+            pos += sizeof(record) + name.size();
+            ++lsn;
+        }
+    }
+    return lastLsn;
+}
+
+void Warehouse::writeSnapshot() {
+    unique_lock<mutex> snapshotGuard(snapshotLock, try_to_lock);
+    if (!snapshotGuard.owns_lock()) return;  // снимок уже пишет другой поток
+
+    vector<uint32_t> itemIds(CELL_COUNT);
+    vector<uint8_t> quantities(CELL_COUNT);
+    string names;
+    SnapshotHeader header = {SNAPSHOT_MAGIC, 0, uint32_t(CELL_COUNT), 0};
+    {
+        auto guards = lockAll();
+        auto namesGuard = items.readLock();
+        for (size_t zone = 0; zone < shards.size(); ++zone) {
+            const ZoneCells& cells = shards[zone].cells;
+            copy(cells.itemId.begin(), cells.itemId.end(), itemIds.begin() + zone * CELLS_PER_ZONE);
+            copy(cells.quantity.begin(), cells.quantity.end(), quantities.begin() + zone * CELLS_PER_ZONE);
+        }
+        const deque<string>& all = items.allNames();
+        header.itemCount = all.size();
+        for (size_t id = 1; id < all.size(); ++id) {
+            uint32_t length = all[id].size();
+            names.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            names.append(all[id]);
+        }
+        header.lsn = wal->rotate();
+    }
+
+    string tmpPath = snapshotPath() + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0
+        && writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header))
+        && writeAll(fd, reinterpret_cast<const char*>(itemIds.data()), sizeof(uint32_t) * CELL_COUNT)
+        && writeAll(fd, reinterpret_cast<const char*>(quantities.data()), CELL_COUNT)
+        && writeAll(fd, names.data(), names.size())
+        && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+    if (!ok || rename(tmpPath.c_str(), snapshotPath().c_str()) != 0) {
+        perror("Ошибка: не удалось записать снимок склада");
+        unlink(tmpPath.c_str());
+        return;
+    }
+    syncDirectory(dataDir);
+    wal->removeSegmentsBefore(header.lsn + 1);
+}
+
+vector<unique_lock<mutex>> Warehouse::lockAll() const {
+    vector<unique_lock<mutex>> guards;
+    guards.reserve(shards.size());
+    for (const ZoneShard& shard : shards) guards.emplace_back(shard.lock);
+    return guards;
+}
+
+int Warehouse::findEmptyCell(int from) const {
+    int startZone = from / CELLS_PER_ZONE;
+    for (size_t step = 0; step <= shards.size(); ++step) {
+        int zone = (startZone + step) % shards.size();
+        int cell = shards[zone].firstEmptyCell(step == 0 ? from % CELLS_PER_ZONE : 0);
+        if (cell >= 0) return zone * CELLS_PER_ZONE + cell;
+    }
+    return -1;
+}
+
+void Warehouse::openStorage(const string& dir) {
+    dataDir = dir;
+    mkdir(dir.c_str(), 0755);
+
+    uint64_t snapshotLsn = loadSnapshot();
+    uint64_t replayed = 0;
+    uint64_t lastLsn = replayLog(snapshotLsn, replayed);
+
+    wal = make_unique<WriteAheadLog>();
+    wal->start(dir, lastLsn, snapshotLsn);
+    items.log = wal.get();
+    // После повтора журнала сразу пишется новый снимок, чтобы следующий запуск был быстрым
+    if (replayed > 0) writeSnapshot();
+}
+
+void Warehouse::commit() {
+    if (!wal) return;
+    wal->sync();
+    if (wal->snapshotDue()) writeSnapshot();
+}
+
+void Warehouse::add(string_view item, int quantity, string_view address, OutputBuffer& out) {
+    int slot = encodeAddress(address);
+    if (slot < 0) {
+        out << "Ошибка: ячейка " << address << " не существует\n";
+        return;
+    }
+
+    ZoneShard& shard = shards[slot / CELLS_PER_ZONE];
+    int cell = slot % CELLS_PER_ZONE;
+    lock_guard<mutex> guard(shard.lock);
+
+    // Новое название регистрируется, только когда товар точно попадает в ячейку:
+    // отклоненная команда не должна оставлять его в реестре, журнале и снимке.
+    // Поиск - под блокировкой шарда, чтобы видеть название, зарегистрированное
+    // другим потоком вместе с записью в эту ячейку
+    uint32_t id = items.find(item);
+
+    int cellQuantity = shard.cells.quantity[cell];
+    if (cellQuantity == 0) {
+        if (quantity > CELL_CAPACITY) {
+            out << "Ошибка: в ячейку нельзя добавить более " << CELL_CAPACITY << " единиц\n";
+            return;
+        }
+        if (id == 0) id = items.intern(item);
+        setCell(slot, id, quantity);
+        out << "Добавлено " << quantity << " ед. товара \"" << item << "\" в " << address << '\n';
+    } else {
+        if (shard.cells.itemId[cell] != id) {
+            out << "Ошибка: ячейка содержит другой товар (\"" << items.name(shard.cells.itemId[cell]) << "\")\n";
+            return;
+        }
+        if (cellQuantity + quantity > CELL_CAPACITY) {
+            out << "Ошибка: превышен лимит ячейки. Доступно место: " << CELL_CAPACITY - cellQuantity << '\n';
+            return;
+        }
+        cellQuantity += quantity;
+        setCell(slot, id, cellQuantity);
+        out << "Обновлено: " << item << " x" << cellQuantity << " в " << address << '\n';
+    }
+}
+
+void Warehouse::remove(string_view item, int quantity, string_view address, OutputBuffer& out) {
+    int slot = encodeAddress(address);
+    if (slot < 0) {
+        out << "Ошибка: ячейка " << address << " не существует\n";
+        return;
+    }
+
+    uint32_t id = items.find(item);
+    ZoneShard& shard = shards[slot / CELLS_PER_ZONE];
+    int cell = slot % CELLS_PER_ZONE;
+    lock_guard<mutex> guard(shard.lock);
+
+    int cellQuantity = shard.cells.quantity[cell];
+    if (cellQuantity == 0) {
+        out << "Ошибка: ячейка " << address << " пуста\n";
+        return;
+    }
+    if (shard.cells.itemId[cell] != id) {
+        out << "Ошибка: в ячейке находится другой товар (\"" << items.name(shard.cells.itemId[cell]) << "\")\n";
+        return;
+    }
+    if (cellQuantity < quantity) {
+        out << "Ошибка: недостаточно товара. Доступно: " << cellQuantity << '\n';
+        return;
+    }
+
+    cellQuantity -= quantity;
+    setCell(slot, id, cellQuantity);
+    out << "Удалено " << quantity << " ед. товара \"" << item << "\" из " << address
+        << ". Остаток: " << cellQuantity << '\n';
+}
+
+void Warehouse::move(string_view item, int quantity, string_view fromAddress, string_view toAddress, OutputBuffer& out) {
+    int from = encodeAddress(fromAddress);
+    int to = encodeAddress(toAddress);
+    if (from < 0 || to < 0) {
+        out << "Ошибка: ячейка " << (from < 0 ? fromAddress : toAddress) << " не существует\n";
+        return;
+    }
+    if (from == to) {
+        out << "Ошибка: ячейки отправления и назначения совпадают\n";
+        return;
+    }
+
+    // Блокировки шардов берутся по возрастанию номера зоны
+    uint32_t id = items.find(item);
+    int fromZone = from / CELLS_PER_ZONE;
+    int toZone = to / CELLS_PER_ZONE;
+    unique_lock<mutex> firstGuard(shards[min(fromZone, toZone)].lock);
+    unique_lock<mutex> secondGuard;
+    if (fromZone != toZone) secondGuard = unique_lock<mutex>(shards[max(fromZone, toZone)].lock);
+
+    const ZoneCells& source = shards[fromZone].cells;
+    const ZoneCells& target = shards[toZone].cells;
+    int fromQuantity = source.quantity[from % CELLS_PER_ZONE];
+    int toQuantity = target.quantity[to % CELLS_PER_ZONE];
+    if (fromQuantity == 0) {
+        out << "Ошибка: ячейка " << fromAddress << " пуста\n";
+        return;
+    }
+    if (source.itemId[from % CELLS_PER_ZONE] != id) {
+        out << "Ошибка: в ячейке находится другой товар (\"" << items.name(source.itemId[from % CELLS_PER_ZONE]) << "\")\n";
+        return;
+    }
+    if (fromQuantity < quantity) {
+        out << "Ошибка: недостаточно товара. Доступно: " << fromQuantity << '\n';
+        return;
+    }
+    if (toQuantity > 0 && target.itemId[to % CELLS_PER_ZONE] != id) {
+        out << "Ошибка: ячейка содержит другой товар (\"" << items.name(target.itemId[to % CELLS_PER_ZONE]) << "\")\n";
+        return;
+    }
+    if (toQuantity + quantity > CELL_CAPACITY) {
+        out << "Ошибка: превышен лимит ячейки. Доступно место: " << CELL_CAPACITY - toQuantity << '\n';
+        return;
+    }
+
+    moveCell(from, to, id, quantity);
+    out << "Перемещено " << quantity << " ед. товара \"" << item << "\" из " << fromAddress
+        << " в " << toAddress << '\n';
+}
+
+void Warehouse::compact(int zone, OutputBuffer& out) {
+    vector<unique_lock<mutex>> guards;
+    if (zone < 0) guards = lockAll();
+    else guards.emplace_back(shards[zone].lock);
+
+    vector<pair<uint32_t, int>> partial;   // id товара, номер ячейки
+    for (size_t z = 0; z < shards.size(); ++z) {
+        if (zone >= 0 && z != size_t(zone)) continue;
+        const ZoneCells& cells = shards[z].cells;
+        for (int word = 0; word < WORDS_PER_ZONE; ++word) {
+            for (uint64_t bits = cells.occupied[word]; bits != 0; bits &= bits - 1) {
+                int cell = word * 64 + __builtin_ctzll(bits);
+                if (cells.quantity[cell] < CELL_CAPACITY) partial.emplace_back(cells.itemId[cell], z * CELLS_PER_ZONE + cell);
+            }
+        }
+    }
+    sort(partial.begin(), partial.end());
+
+    size_t moveCount = 0;
+    size_t freed = 0;
+    vector<pair<int, int>> cells;
+    vector<CellMove> moves;
+    for (size_t begin = 0; begin < partial.size();) {
+        uint32_t id = partial[begin].first;
+        cells.clear();
+        size_t end = begin;
+        for (; end < partial.size() && partial[end].first == id; ++end) {
+            int slot = partial[end].second;
+            cells.emplace_back(slot, shards[slot / CELLS_PER_ZONE].cells.quantity[slot % CELLS_PER_ZONE]);
+        }
+        begin = end;
+
+        moves.clear();
+        planCompaction(cells, moves);
+        for (const CellMove& move : moves) {
+            moveCell(move.from, move.to, id, move.quantity);
+            if (shards[move.from / CELLS_PER_ZONE].cells.quantity[move.from % CELLS_PER_ZONE] == 0) ++freed;
+            out << "Перемещено " << move.quantity << " ед. товара \"" << items.name(id) << "\" из "
+                << decodeAddress(move.from) << " в " << decodeAddress(move.to) << '\n';
+        }
+        moveCount += moves.size();
+    }
+
+    if (zone < 0) out << "Уплотнение склада";
+    else out << "Уплотнение зоны " << ZONES[zone];
+    out << ": перемещений " << moveCount << ", освобождено ячеек " << freed << '\n';
+}
+
+void Warehouse::info(bool summaryOnly, OutputBuffer& out) const {
+    vector<ZoneCells> snapshot(shards.size());
+    {
+        auto guards = lockAll();
+        for (size_t zone = 0; zone < shards.size(); ++zone) {
+            const ZoneCells& cells = shards[zone].cells;
+            if (summaryOnly) {
+                snapshot[zone].totalItems = cells.totalItems;
+                snapshot[zone].occupiedCount = cells.occupiedCount;
+            } else {
+                snapshot[zone] = cells;
+            }
+        }
+    }
+
+    long long totalItems = 0;
+    int occupiedCount = 0;
+    for (const ZoneCells& zone : snapshot) {
+        totalItems += zone.totalItems;
+        occupiedCount += zone.occupiedCount;
+    }
+
+    out << "Общая загруженность: "
+        << (totalItems / double(CELL_COUNT * CELL_CAPACITY) * 100) << "%\n";
+
+    for (size_t zone = 0; zone < ZONES.size(); ++zone) {
+        double percent = (snapshot[zone].totalItems / double(CELLS_PER_ZONE * CELL_CAPACITY)) * 100;
+        out << "Зона " << ZONES[zone] << ": " << percent << "%\n";
+    }
+
+    if (summaryOnly) {
+        out << "Заполненные ячейки: " << occupiedCount
+            << ", пустые ячейки: " << CELL_COUNT - occupiedCount << '\n';
+        return;
+    }
+
+    // Списки ячеек в порядке адресов; строки адресов посчитаны заранее
+    out << "\nЗаполненные ячейки (" << occupiedCount << "):\n";
+    for (const auto& [address, slot] : addressOrder()) {
+        const ZoneCells& cells = snapshot[slot / CELLS_PER_ZONE];
+        int cell = slot % CELLS_PER_ZONE;
+        if (cells.quantity[cell] == 0) continue;
+        out << "  " << address << ": \"" << items.name(cells.itemId[cell]) << "\" x" << cells.quantity[cell] << '\n';
+    }
+
+    out << "\nПустые ячейки (" << CELL_COUNT - occupiedCount << "):\n";
+    for (const auto& [address, slot] : addressOrder()) {
+        if (snapshot[slot / CELLS_PER_ZONE].quantity[slot % CELLS_PER_ZONE] == 0) out << "  " << address << '\n';
+    }
+}
+
+void Warehouse::find(string_view item, OutputBuffer& out) const {
+    uint32_t id = items.find(item);
+    vector<pair<int, int>> found;   // номер ячейки, количество
+    if (id != 0) {
+        auto guards = lockAll();
+        for (size_t zone = 0; zone < shards.size(); ++zone) {
+            for (int cell : shards[zone].cellsOf(id)) {
+                found.emplace_back(zone * CELLS_PER_ZONE + cell, shards[zone].cells.quantity[cell]);
+            }
+        }
+    }
+
+    if (found.empty()) {
+        out << "Товар \"" << item << "\" на складе отсутствует\n";
+        return;
+    }
+
+    int total = 0;
+    for (const auto& [slot, quantity] : found) total += quantity;
+    out << "Товар \"" << item << "\": " << total << " ед. в " << found.size() << " ячейках\n";
+    for (const auto& [slot, quantity] : found) {
+        out << "  " << decodeAddress(slot) << ": x" << quantity << '\n';
+    }
+}
+
+void Warehouse::put(string_view item, int quantity, OutputBuffer& out) {
+    // Как в add: новое название регистрируется только после проверки вместимости
+    auto guards = lockAll();
+    uint32_t id = items.find(item);
+
+    // Проверка вместимости до размещения, чтобы команда выполнялась целиком или никак
+    // Пустые ячейки потом ищутся от ячейки этого товара с наименьшим номером
+    // (порядок списка cellsOf зависит от истории удалений и для этого не годится)
+    long long available = 0;
+    int anchor = -1;
+    for (size_t zone = 0; zone < shards.size(); ++zone) {
+        const ZoneShard& shard = shards[zone];
+        const vector<int>& cells = shard.cellsOf(id);
+        available += (long long)(CELLS_PER_ZONE - shard.cells.occupiedCount) * CELL_CAPACITY;
+        for (int cell : cells) available += CELL_CAPACITY - shard.cells.quantity[cell];
+        if (anchor < 0 && !cells.empty()) anchor = zone * CELLS_PER_ZONE + *min_element(cells.begin(), cells.end());
+    }
+    if (quantity > available) {
+        out << "Ошибка: недостаточно места на складе. Доступно: " << available << '\n';
+        return;
+    }
+    if (id == 0) id = items.intern(item);
+
+    int remaining = quantity;
+    for (size_t zone = 0; zone < shards.size() && remaining > 0; ++zone) {
+        ZoneShard& shard = shards[zone];
+        const vector<int>& cells = shard.cellsOf(id);
+        for (size_t i = 0; i < cells.size() && remaining > 0; ++i) {
+            int cell = cells[i];
+            int cellQuantity = shard.cells.quantity[cell];
+            int added = min(remaining, CELL_CAPACITY - cellQuantity);
+            if (added == 0) continue;
+            setCell(zone * CELLS_PER_ZONE + cell, id, cellQuantity + added);
+            remaining -= added;
+            out << "Обновлено: " << item << " x" << cellQuantity + added << " в "
+                << decodeAddress(zone * CELLS_PER_ZONE + cell) << '\n';
+        }
+    }
+
+    // Пустые ячейки ищутся рядом с уже занятыми этим товаром
+    if (anchor < 0) anchor = 0;
+    while (remaining > 0) {
+        int slot = findEmptyCell(anchor);
+        int added = min(remaining, CELL_CAPACITY);
+        setCell(slot, id, added);
+        remaining -= added;
+        anchor = slot;
+        out << "Добавлено " << added << " ед. товара \"" << item << "\" в " << decodeAddress(slot) << '\n';
+    }
+}
+
+void processAddCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    if (tokens.size() != 4) {
+        out << "Ошибка: неверный формат команды. Используйте: ADD <товар> <количество> <адрес>\n";
+        return;
+    }
+    
+    int quantity;
+    if (!parseQuantity(tokens[2], quantity)) {
+        out << "Ошибка: количество должно быть положительным числом\n";
+        return;
+    }
+    
+    warehouse.add(tokens[1], quantity, tokens[3], out);
+}
+
+void processRemoveCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    if (tokens.size() != 4) {
+        out << "Ошибка: неверный формат команды. Используйте: REMOVE <товар> <количество> <адрес>\n";
+        return;
+    }
+    
+    int quantity;
+    if (!parseQuantity(tokens[2], quantity)) {
+        out << "Ошибка: количество должно быть положительным числом\n";
+        return;
+    }
+    
+    warehouse.remove(tokens[1], quantity, tokens[3], out);
+}
+
+// INFO выводит сводку и списки ячеек; INFO SUMMARY - только сводку
+void processInfoCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    bool summaryOnly = tokens.size() == 2 && tokens[1] == "SUMMARY";
+    if (tokens.size() > 1 && !summaryOnly) {
+        out << "Ошибка: неверный формат команды. Используйте: INFO [SUMMARY]\n";
+        return;
+    }
+
+    warehouse.info(summaryOnly, out);
+}
+
+void processFindCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    if (tokens.size() != 2) {
+        out << "Ошибка: неверный формат команды. Используйте: FIND <товар>\n";
+        return;
+    }
+
+    warehouse.find(tokens[1], out);
+}
+
+void processPutCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    if (tokens.size() != 3) {
+        out << "Ошибка: неверный формат команды. Используйте: PUT <товар> <количество>\n";
+        return;
+    }
+
+    int quantity;
+    if (!parseQuantity(tokens[2], quantity)) {
+        out << "Ошибка: количество должно быть положительным числом\n";
+        return;
+    }
+
+    warehouse.put(tokens[1], quantity, out);
+}
+
+void processMoveCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    if (tokens.size() != 5) {
+        out << "Ошибка: неверный формат команды. Используйте: MOVE <товар> <количество> <откуда> <куда>\n";
+        return;
+    }
+
+    int quantity;
+    if (!parseQuantity(tokens[2], quantity)) {
+        out << "Ошибка: количество должно быть положительным числом\n";
+        return;
+    }
+
+    warehouse.move(tokens[1], quantity, tokens[3], tokens[4], out);
+}
+
+// COMPACT уплотняет весь склад, COMPACT <зона> - одну зону
+void processCompactCommand(const vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    if (tokens.size() > 2) {
+        out << "Ошибка: неверный формат команды. Используйте: COMPACT [зона]\n";
+        return;
+    }
+
+    int zone = -1;
+    if (tokens.size() == 2) {
+        zone = tokens[1].size() == 1 ? zoneIndex[static_cast<unsigned char>(tokens[1][0])] : -1;
+        if (zone < 0) {
+            out << "Ошибка: зона " << tokens[1] << " не существует\n";
+            return;
+        }
+    }
+
+    warehouse.compact(zone, out);
+}
+
+void processStatsCommand(const vector<string_view>& tokens, Warehouse&, OutputBuffer& out) {
+    if (tokens.size() != 1) {
+        out << "Ошибка: неверный формат команды. Используйте: STATS\n";
+        return;
+    }
+
+    out << commandStats.report();
+}
+
+using CommandHandler = void (*)(const vector<string_view>&, Warehouse&, OutputBuffer&);
+
+// Команды склада пишутся заглавными буквами; совершенный хеш подбирается при компиляции
+constexpr auto commandHandlers = tokenizer::makeKeywordTable<CommandHandler, false>({
+    {"ADD", processAddCommand},
+    {"REMOVE", processRemoveCommand},
+    {"INFO", processInfoCommand},
+    {"FIND", processFindCommand},
+    {"PUT", processPutCommand},
+    {"MOVE", processMoveCommand},
+    {"COMPACT", processCompactCommand},
+    {"STATS", processStatsCommand},
+}, nullptr);
+
+// Токены строки ссылаются на исходную строку, без копирования
+void processLine(string_view line, vector<string_view>& tokens, Warehouse& warehouse, OutputBuffer& out) {
+    tokenizer::split(line, tokens);
+    if (tokens.empty()) return;
+
+    string_view cmd = tokens[0];
+    CommandHandler handler = commandHandlers.find(cmd);
+    if (!handler) {
+        out << "Ошибка: неизвестная команда \"" << cmd << "\"\n";
+        return;
+    }
+    // Время каждой команды попадает в счетчик с ее именем
+    instrumentation::ScopedTimer timer(commandStats[cmd]);
+    handler(tokens, warehouse, out);
+}
+
+void commitCommands(Warehouse& warehouse) {
+    instrumentation::ScopedTimer timer(commandStats["commit"]);
+    warehouse.commit();
+}
+
+void runBatch(FILE* input, FILE* output, Warehouse& warehouse, OutputBuffer& out) {
+    const size_t BLOCK_SIZE = 1 << 20;
+    vector<char> buffer(BLOCK_SIZE);
+    vector<string_view> tokens;
+    size_t filled = 0;
+
+    while (true) {
+        if (filled == buffer.size()) buffer.resize(buffer.size() * 2); // строка длиннее блока
+        size_t bytesRead = fread(buffer.data() + filled, 1, buffer.size() - filled, input);
+        filled += bytesRead;
+        bool eof = bytesRead == 0;
+
+        size_t lineStart = 0;
+        const char* data = buffer.data();
+        while (const void* newline = memchr(data + lineStart, '\n', filled - lineStart)) {
+            size_t lineEnd = static_cast<const char*>(newline) - data;
+            processLine(string_view(data + lineStart, lineEnd - lineStart), tokens, warehouse, out);
+            lineStart = lineEnd + 1;
+        }
+        if (eof && lineStart < filled) {
+            processLine(string_view(data + lineStart, filled - lineStart), tokens, warehouse, out);
+            lineStart = filled;
+        }
+
+        // Незавершенная строка переносится в начало буфера
+        memmove(buffer.data(), buffer.data() + lineStart, filled - lineStart);
+        filled -= lineStart;
+        // Ответы выводятся только после того, как изменения пачки записаны на диск
+        commitCommands(warehouse);
+        out.flush(output);
+        if (eof) break;
+    }
+}
+
+}
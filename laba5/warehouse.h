@@ -0,0 +1,291 @@
+// warehouse.h
+// Движок склада (лабораторная 1): ячейки, журнал упреждающей записи, снимки и
+// обработка команд. Используется программой ex1 и сервером (server/).
+#ifndef WAREHOUSE_H
+#define WAREHOUSE_H
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "instrumentation.h"
+
+namespace ex1 {
+
+// Геометрия склада: зона / стеллаж / секция / полка
+constexpr std::array<char, 3> ZONES = {'A', 'B', 'C'}; // Исправлены кириллические символы
+const int SHELVES = 20;
+const int SECTIONS = 5;
+const int RACKS = 2;
+const int CELL_CAPACITY = 10;
+const int CELLS_PER_ZONE = SHELVES * SECTIONS * RACKS;
+const int CELL_COUNT = CELLS_PER_ZONE * ZONES.size();
+const int WORDS_PER_ZONE = (CELLS_PER_ZONE + 63) / 64;
+
+// Преобразование адреса вида "A1234" в номер ячейки; -1, если адрес не существует
+int encodeAddress(std::string_view address);
+
+// Обратное преобразование номера ячейки в адрес
+std::string decodeAddress(int slot);
+
+// Буфер ответов: вывод копится в памяти и записывается в stdout одним вызовом
+struct OutputBuffer {
+    std::string data;
+
+    OutputBuffer& operator<<(std::string_view s) {
+        data.append(s);
+        return *this;
+    }
+    OutputBuffer& operator<<(char c) {
+        data.push_back(c);
+        return *this;
+    }
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    OutputBuffer& operator<<(T value) {
+        char buf[24];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        data.append(buf, result.ptr);
+        return *this;
+    }
+    // Дробные числа (проценты) выводятся с двумя знаками после запятой
+    OutputBuffer& operator<<(double value) {
+        char buf[32];
+        int length = std::snprintf(buf, sizeof(buf), "%.2f", value);
+        data.append(buf, length);
+        return *this;
+    }
+
+    void flush(std::FILE* file = stdout) {
+        std::fwrite(data.data(), 1, data.size(), file);
+        std::fflush(file);
+        data.clear();
+    }
+};
+
+// Число и время выполнения команд (и фиксаций журнала), выводятся командой STATS
+extern instrumentation::CommandStats commandStats;
+
+// Разбор количества по правилам stoi из исходной версии: необязательный знак,
+// хотя бы одна цифра, символы после числа не учитываются ("5abc" - это 5);
+// число вне диапазона int и количество <= 0 - ошибка
+bool parseQuantity(std::string_view token, int& quantity);
+
+class WriteAheadLog;
+struct MappedFile;
+
+// Реестр названий товаров: название <-> id. Id 0 зарезервирован за пустой ячейкой.
+// Общий для всех зон, поэтому защищен собственной блокировкой.
+class ItemRegistry {
+private:
+    mutable std::shared_mutex lock;
+    std::deque<std::string> names;                        // id товара -> название
+    std::unordered_map<std::string_view, uint32_t> ids;   // название -> id товара (ключи ссылаются на names)
+
+public:
+    // Журнал, в который пишутся новые названия (nullptr - без журнала)
+    WriteAheadLog* log = nullptr;
+
+    ItemRegistry() : names(1) {}
+
+    // Получение id товара, регистрация нового названия при первом обращении.
+    // Название попадает в журнал под блокировкой, то есть раньше любой записи о ячейке с ним.
+    uint32_t intern(std::string_view item);
+
+    // Восстановление названия с известным id из снимка или журнала
+    void restore(uint32_t id, std::string_view item) {
+        std::unique_lock<std::shared_mutex> guard(lock);
+        if (id < names.size()) return;
+        while (names.size() < id) names.emplace_back();  // пропуски от оборванного журнала
+        names.emplace_back(item);
+        ids.emplace(names.back(), id);
+    }
+
+    // Блокировка на чтение для копирования всех названий (снимок склада)
+    std::shared_lock<std::shared_mutex> readLock() const {
+        return std::shared_lock<std::shared_mutex>(lock);
+    }
+
+    // Вызывается под readLock()
+    const std::deque<std::string>& allNames() const {
+        return names;
+    }
+
+    // Поиск id товара без регистрации; 0, если такого товара еще не было
+    uint32_t find(std::string_view item) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        auto it = ids.find(item);
+        return it != ids.end() ? it->second : 0;
+    }
+
+    // Элементы deque не перемещаются при добавлении, поэтому ссылка остается валидной
+    const std::string& name(uint32_t id) const {
+        std::shared_lock<std::shared_mutex> guard(lock);
+        return names[id];
+    }
+};
+
+// Данные ячеек одной зоны в виде структуры массивов: номер ячейки в зоне -> id товара и количество
+struct ZoneCells {
+    std::vector<uint32_t> itemId;
+    std::vector<uint8_t> quantity;
+
+    // Счетчики, поддерживаемые при каждом изменении ячейки
+    long long totalItems = 0;
+    std::vector<uint64_t> occupied;     // битовая маска занятых ячеек
+    int occupiedCount = 0;
+};
+
+// Маска существующих ячеек в слове битовой маски зоны
+inline uint64_t validCellsMask(int word) {
+    if (CELLS_PER_ZONE % 64 != 0 && word + 1 == WORDS_PER_ZONE) {
+        return (uint64_t(1) << (CELLS_PER_ZONE % 64)) - 1;
+    }
+    return ~uint64_t(0);
+}
+
+// Шард склада: одна зона под собственной блокировкой вместе с индексами
+struct ZoneShard {
+    mutable std::mutex lock;
+    ZoneCells cells;
+    std::vector<uint64_t> freeWords;    // бит w установлен, если в слове occupied[w] есть свободная ячейка
+
+    // Обратный индекс: id товара -> номера ячеек зоны с этим товаром
+    std::vector<std::vector<int>> itemCells;
+    std::vector<int> itemCellPos;       // номер ячейки -> позиция в списке itemCells ее товара
+
+    ZoneShard();
+
+    const std::vector<int>& cellsOf(uint32_t item) const {
+        static const std::vector<int> none;
+        return item < itemCells.size() ? itemCells[item] : none;
+    }
+
+    void addToItemIndex(uint32_t item, int cell) {
+        if (item >= itemCells.size()) itemCells.resize(item + 1);
+        itemCellPos[cell] = itemCells[item].size();
+        itemCells[item].push_back(cell);
+    }
+
+    // Удаление за O(1): на место ячейки ставится последняя ячейка списка
+    void removeFromItemIndex(uint32_t item, int cell);
+
+    // Изменение количества товара в ячейке с обновлением счетчиков и индексов за O(1)
+    void setCell(int cell, uint32_t item, int quantity);
+
+    // Первая свободная ячейка зоны с номером не меньше from; -1, если таких нет.
+    // Поиск идет по двухуровневой маске, поэтому занимает O(CELLS_PER_ZONE / 4096) операций.
+    int firstEmptyCell(int from) const;
+};
+
+// Перемещение части товара из одной ячейки в другую
+struct CellMove {
+    int from;
+    int to;
+    int quantity;
+};
+
+// Движок склада. Ячейки разбиты на шарды по зонам, у каждого шарда своя блокировка,
+// поэтому команды из разных потоков для разных зон выполняются параллельно.
+// Операции над несколькими зонами берут блокировки шардов по возрастанию номера зоны.
+class Warehouse {
+private:
+    std::vector<ZoneShard> shards;
+    ItemRegistry items;
+
+    // Долговременное хранение (включается openStorage)
+    std::unique_ptr<WriteAheadLog> wal;
+    std::string dataDir;
+    std::mutex snapshotLock;
+
+    // Изменение ячейки с записью в журнал; вызывается под блокировкой шарда
+    void setCell(int slot, uint32_t id, int quantity);
+
+    // Перемещение товара между ячейками одной группой записей журнала, чтобы после
+    // сбоя товар не пропал и не удвоился; вызывается под блокировками обоих шардов
+    void moveCell(int from, int to, uint32_t id, int quantity);
+
+    std::string snapshotPath() const {
+        return dataDir + "/warehouse.snap";
+    }
+
+    // Загрузка последнего снимка через mmap; возвращает LSN снимка (0, если снимка нет)
+    uint64_t loadSnapshot();
+
+    // Все count записей группы, начиная со смещения pos, целы
+    static bool groupComplete(const MappedFile& file, size_t pos, uint32_t count);
+
+    // Повтор сегментов журнала после снимка. Чтение сегмента прекращается на первой
+    // неполной или поврежденной записи: это хвост, не попавший на диск целиком.
+    uint64_t replayLog(uint64_t snapshotLsn, uint64_t& replayed);
+
+    // Снимок всех ячеек: состояние копируется под блокировками вместе с переходом
+    // журнала на новый сегмент, а запись файла идет уже без блокировок
+    void writeSnapshot();
+
+    // Блокировка всех шардов (для команд, которым нужна согласованная картина склада)
+    std::vector<std::unique_lock<std::mutex>> lockAll() const;
+
+    // Первая свободная ячейка склада начиная с номера from (по кругу); -1, если свободных нет.
+    // Вызывается при заблокированных шардах.
+    int findEmptyCell(int from) const;
+
+public:
+    Warehouse();
+    ~Warehouse();
+
+    // Включение долговременного хранения в каталоге dir: восстановление из
+    // последнего снимка и хвоста журнала, затем запись всех изменений в журнал
+    void openStorage(const std::string& dir);
+
+    // Фиксация изменений: один fdatasync на все накопленные записи, при необходимости снимок
+    void commit();
+
+    void add(std::string_view item, int quantity, std::string_view address, OutputBuffer& out);
+
+    void remove(std::string_view item, int quantity, std::string_view address, OutputBuffer& out);
+
+    // Атомарное перемещение: проверяются обе ячейки, затем изменяются обе сразу
+    void move(std::string_view item, int quantity, std::string_view fromAddress, std::string_view toAddress, OutputBuffer& out);
+
+    // Уплотнение зоны (zone < 0 - всего склада): частично заполненные ячейки каждого
+    // товара сливаются в полные по плану planCompaction. Ячейки собираются одним
+    // проходом по битовым маскам и группируются сортировкой, то есть O(n log n).
+    void compact(int zone, OutputBuffer& out);
+
+    // Сводка и списки ячеек по согласованному снимку. Блокировки держатся только
+    // на время копирования данных зон, форматирование идет уже без них.
+    void info(bool summaryOnly, OutputBuffer& out) const;
+
+    // Все ячейки с товаром и общий остаток, за O(k) по обратному индексу
+    void find(std::string_view item, OutputBuffer& out) const;
+
+    // Автоматическое размещение. Сначала дополняются частично заполненные ячейки
+    // с этим товаром, затем занимаются ближайшие пустые.
+    void put(std::string_view item, int quantity, OutputBuffer& out);
+};
+
+// Разбор и выполнение одной строки команды; ответ дописывается в out.
+// tokens - рабочий буфер, токены ссылаются на line без копирования.
+void processLine(std::string_view line, std::vector<std::string_view>& tokens, Warehouse& warehouse, OutputBuffer& out);
+
+// Фиксация выполненных команд (Warehouse::commit) с замером времени для STATS.
+// Как и processLine, вызывается из потока, разбирающего команды: commandStats
+// не защищен блокировкой, а сам Warehouse может использоваться из разных потоков.
+void commitCommands(Warehouse& warehouse);
+
+// Пакетный режим: вход читается блоками по 1 МБ, строки разбираются прямо в буфере,
+// ответы на блок сбрасываются в output одним вызовом после commitCommands
+void runBatch(std::FILE* input, std::FILE* output, Warehouse& warehouse, OutputBuffer& out);
+
+}
+
+#endif